@@ -13,12 +13,20 @@ if "tests" in sys.argv:
     else:
         build_target = "tests"
 
+if "benchmarks" in sys.argv:
+    if build_target in ["rnjin", "tests"]:
+        build_target = "all"
+    else:
+        build_target = "benchmarks"
+
 output_log     = "./logs/_scons.log"
 engine_run_log = "./logs/_run.log"
 tests_run_log  = "./logs/_tests.log"
+benchmarks_run_log = "./logs/_benchmarks.log"
 
 engine_executable = "rnjin.exe"
 tests_executable  = "tests.exe"
+benchmarks_executable = "benchmarks.exe"
 
 build_result = 0
 
@@ -58,7 +66,9 @@ if build_result == 0:
             for arg in sys.argv[start:]:
                 run_args = f"{run_args} {arg}"
 
-        if "tests" in sys.argv:
+        if "benchmarks" in sys.argv:
+            command = f"{benchmarks_executable}{run_args} > {benchmarks_run_log}"
+        elif "tests" in sys.argv:
             command = f"{tests_executable}{run_args} > {tests_run_log}"
         else:
             command = f"{engine_executable}{run_args} > {engine_run_log}"
@@ -0,0 +1,2 @@
+@echo off
+py build.py benchmarks quietly run -- %*
\ No newline at end of file
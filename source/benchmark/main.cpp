@@ -0,0 +1,49 @@
+/* *** ** *** ** *** ** *** *
+ * Part of rnjin            *
+ * (c) Rajin Shankar, 2019  *
+ *        rajinshankar.com  *
+ * *** ** *** ** *** ** *** */
+#include <rnjin.hpp>
+
+#include <iostream>
+
+#include "core/module.h"
+#include "console/module.h"
+#include "benchmark/module.h"
+
+using namespace rnjin;
+
+// Run the benchmarks named in the arguments (or "all" of them), then write their results to benchmark_results.json
+// note: results are written as JSON so they can be compared between releases
+int main( int argc, char* argv[] )
+{
+    console::parse_arguments( { "-af", "params/benchmark" } );
+
+    try
+    {
+        for ( uint i : range( argc ) )
+        {
+            // Skip the first argument (executable name)
+            if ( i == 0 ) continue;
+
+            string benchmark_name = string( argv[i] );
+
+            if ( benchmark_name == "all" )
+            {
+                benchmark::execute_all_benchmark_actions();
+                break;
+            }
+            else
+            {
+                benchmark::execute_benchmark_action( benchmark_name );
+            }
+        }
+
+        benchmark::write_results( "benchmark_results.json" );
+        std::cout << std::endl << "Finished benchmarks" << std::endl;
+    }
+    catch ( std::exception e )
+    {
+        std::cout << "Error: " << e.what() << std::endl;
+    }
+}
@@ -91,6 +91,8 @@ void main( int argc, char* argv[] )
             while ( not glfwWindowShouldClose( main_window.get_api_window() ) )
             {
                 glfwPollEvents();
+                resource::events.resource_no_longer_referenced().dispatch();
+
                 let advance = glfwGetKey( main_window.get_api_window(), GLFW_KEY_A );
                 let run     = glfwGetKey( main_window.get_api_window(), GLFW_KEY_S );
                 if ( advance )
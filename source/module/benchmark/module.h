@@ -0,0 +1,9 @@
+/* *** ** *** ** *** ** *** *
+ * Part of rnjin            *
+ * (c) Rajin Shankar, 2019  *
+ *        rajinshankar.com  *
+ * *** ** *** ** *** ** *** */
+
+#pragma once
+
+#include "public/benchmark.hpp"
@@ -0,0 +1,98 @@
+/* *** ** *** ** *** ** *** *
+ * Part of rnjin            *
+ * (c) Rajin Shankar, 2019  *
+ *        rajinshankar.com  *
+ * *** ** *** ** *** ** *** */
+
+#include <iomanip>
+#include <sstream>
+
+#include "benchmark.hpp"
+#include "file/module.h"
+
+namespace rnjin::benchmark
+{
+    group result
+    {
+        string benchmark_name;
+        string case_name;
+        usize operation_count;
+        double elapsed_nanoseconds;
+    };
+
+    dictionary<string, action>& get_benchmark_actions()
+    {
+        static dictionary<string, action> benchmark_actions;
+        return benchmark_actions;
+    }
+
+    list<result>& get_results()
+    {
+        static list<result> results;
+        return results;
+    }
+
+    // Name of the benchmark currently executing, which new results are recorded under
+    string& get_current_benchmark_name()
+    {
+        static string current_benchmark_name;
+        return current_benchmark_name;
+    }
+
+    void add_benchmark_action( const string& name, action benchmark_action )
+    {
+        get_benchmark_actions()[name] = benchmark_action;
+    }
+
+    void execute_benchmark_action( const string& name )
+    {
+        let actions = get_benchmark_actions();
+        if ( actions.count( name ) > 0 )
+        {
+            std::cout << std::endl << "Executing benchmark '" << name << "'" << std::endl;
+            get_current_benchmark_name() = name;
+            actions.at( name )();
+            std::cout << std::endl << "Finished benchmark '" << name << "'" << std::endl;
+        }
+        else
+        {
+            std::cout << std::endl << "Failed to find benchmark '" << name << "'" << std::endl;
+        }
+    }
+
+    void execute_all_benchmark_actions()
+    {
+        foreach ( pair : get_benchmark_actions() )
+        {
+            execute_benchmark_action( pair.first );
+        }
+    }
+
+    void add_result( const string& case_name, const usize operation_count, const double elapsed_nanoseconds )
+    {
+        get_results().push_back( result{ get_current_benchmark_name(), case_name, operation_count, elapsed_nanoseconds } );
+
+        let nanoseconds_per_operation = operation_count > 0 ? elapsed_nanoseconds / double( operation_count ) : 0.0;
+        std::cout << "      " << std::left << std::setw( 40 ) << case_name << std::right << std::setw( 12 ) << std::fixed << std::setprecision( 2 ) << nanoseconds_per_operation << " ns/op ("
+                  << operation_count << " ops)" << std::endl;
+    }
+
+    void write_results( const string& path )
+    {
+        std::ostringstream json;
+        json << "[" << std::endl;
+        for ( usize i = 0; i < get_results().size(); i++ )
+        {
+            let& entry                    = get_results()[i];
+            let nanoseconds_per_operation = entry.operation_count > 0 ? entry.elapsed_nanoseconds / double( entry.operation_count ) : 0.0;
+
+            // note: benchmark and case names are identifiers and sizes, so they're written without escaping
+            json << "  { \"benchmark\": \"" << entry.benchmark_name << "\", \"case\": \"" << entry.case_name << "\", \"operations\": " << entry.operation_count
+                 << ", \"total_ns\": " << entry.elapsed_nanoseconds << ", \"ns_per_op\": " << nanoseconds_per_operation << " }" << ( i + 1 < get_results().size() ? "," : "" ) << std::endl;
+        }
+        json << "]" << std::endl;
+
+        io::file output( path, io::file::mode::write );
+        output.write_all_text( json.str() );
+    }
+} // namespace rnjin::benchmark
@@ -0,0 +1,60 @@
+/* *** ** *** ** *** ** *** *
+ * Part of rnjin            *
+ * (c) Rajin Shankar, 2019  *
+ *        rajinshankar.com  *
+ * *** ** *** ** *** ** *** */
+
+#pragma once
+#include <rnjin.hpp>
+
+#include <chrono>
+#include <iostream>
+
+#include "core/module.h"
+
+namespace rnjin::benchmark
+{
+    void add_benchmark_action( const string& name, action benchmark_action );
+    void execute_benchmark_action( const string& name );
+    void execute_all_benchmark_actions();
+
+    // Record the time taken by a number of operations in the benchmark that's currently executing
+    void add_result( const string& case_name, const usize operation_count, const double elapsed_nanoseconds );
+    // Write every recorded result to a JSON file, as a list of { benchmark, case, operations, total_ns, ns_per_op }
+    void write_results( const string& path );
+
+    // Time a function performing a number of operations, and record the result
+    // ex. `measure( "lookup/1000", 1000, [&] { for ( ... ) { ... } } );`
+    template <typename function_type>
+    void measure( const string& case_name, const usize operation_count, const function_type& function )
+    {
+        let start = std::chrono::steady_clock::now();
+        function();
+        let elapsed = std::chrono::duration<double, std::nano>( std::chrono::steady_clock::now() - start ).count();
+        add_result( case_name, operation_count, elapsed );
+    }
+
+    // Keep the optimizer from discarding a value that is only computed to be measured
+    template <typename T>
+    void keep( const T& value )
+    {
+        static volatile const void* sink;
+        sink = &value;
+    }
+} // namespace rnjin::benchmark
+
+#define benchmark( name )                                                                              \
+    namespace                                                                                          \
+    {                                                                                                  \
+        struct benchmark_##name##_container                                                            \
+        {                                                                                              \
+            static void run();                                                                         \
+            benchmark_##name##_container()                                                             \
+            {                                                                                          \
+                std::cout << "Registered benchmark '" #name "' from '" __FILE__ "'" << std::endl;      \
+                rnjin::benchmark::add_benchmark_action( #name, run );                                  \
+            }                                                                                          \
+        };                                                                                             \
+        static benchmark_##name##_container _benchmark_##name;                                         \
+    }                                                                                                  \
+    void ::benchmark_##name##_container::run()
@@ -0,0 +1,137 @@
+/* *** ** *** ** *** ** *** *
+ * Part of rnjin            *
+ * (c) Rajin Shankar, 2019  *
+ *        rajinshankar.com  *
+ * *** ** *** ** *** ** *** */
+
+#include <rnjin.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <unordered_map>
+
+#include "benchmark/module.h"
+#include "core/module.h"
+
+using namespace rnjin;
+using namespace rnjin::core;
+using namespace rnjin::benchmark;
+
+/* -------------------------------------------------------------------------- */
+/*                                   Helpers                                  */
+/* -------------------------------------------------------------------------- */
+
+// Numbers of keys each benchmark is run with
+static const usize key_counts[] = { 100, 10000, 1000000 };
+
+static string get_case_name( const string& operation, const string& table_name, const usize count )
+{
+    return operation + "/" + table_name + "/" + std::to_string( count );
+}
+
+// Time inserting, finding, iterating over and erasing keys with a dictionary type
+// note: keys are looked up and erased in a different order than they were inserted, and missing keys are looked up
+//       from a separate list of keys that are never inserted
+template <typename dictionary_type, typename key_type>
+static void measure_dictionary( const string& table_name, const list<key_type>& keys, const list<key_type>& missing_keys )
+{
+    let count = keys.size();
+
+    list<key_type> shuffled_keys( keys.begin(), keys.end() );
+    std::shuffle( shuffled_keys.begin(), shuffled_keys.end(), std::mt19937( 1234 ) );
+
+    dictionary_type table;
+    usize found = 0;
+    measure( get_case_name( "insert", table_name, count ), count, [&] {
+        foreach ( key : keys )
+        {
+            table.emplace( key, 1 );
+        }
+    } );
+    measure( get_case_name( "find_present", table_name, count ), count, [&] {
+        foreach ( key : shuffled_keys )
+        {
+            found += table.count( key );
+        }
+    } );
+    measure( get_case_name( "find_missing", table_name, count ), count, [&] {
+        foreach ( key : missing_keys )
+        {
+            found += table.count( key );
+        }
+    } );
+    measure( get_case_name( "iterate", table_name, count ), count, [&] {
+        foreach ( element : table )
+        {
+            found += element.second;
+        }
+    } );
+    measure( get_case_name( "erase", table_name, count ), count, [&] {
+        foreach ( key : shuffled_keys )
+        {
+            table.erase( key );
+        }
+    } );
+
+    keep( found );
+}
+
+// Time the engine's dictionary against the standard one with the same keys
+template <typename key_type>
+static void compare_dictionaries( const list<key_type>& keys, const list<key_type>& missing_keys )
+{
+    measure_dictionary<dictionary<key_type, int>>( "flat", keys, missing_keys );
+    measure_dictionary<std::unordered_map<key_type, int>>( "std", keys, missing_keys );
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                 Benchmarks                                 */
+/* -------------------------------------------------------------------------- */
+
+// Ids of a placeholder type, created in order like the ids of resources
+struct bench_id_owner;
+using bench_id = unique_id<bench_id_owner>;
+
+benchmark( dictionary_unique_id_keys )
+{
+    foreach ( count : key_counts )
+    {
+        list<bench_id> keys( count );
+        list<bench_id> missing_keys( count );
+        compare_dictionaries( keys, missing_keys );
+    }
+}
+
+benchmark( dictionary_pointer_keys )
+{
+    foreach ( count : key_counts )
+    {
+        // Pointers to separately allocated objects, as with windows or resources
+        list<std::unique_ptr<int>> objects;
+        list<const int*> keys;
+        list<const int*> missing_keys;
+        for ( usize i = 0; i < count * 2; i++ )
+        {
+            objects.emplace_back( new int( 0 ) );
+            ( i % 2 == 0 ? keys : missing_keys ).push_back( objects.back().get() );
+        }
+        compare_dictionaries( keys, missing_keys );
+    }
+}
+
+benchmark( dictionary_string_keys )
+{
+    foreach ( count : key_counts )
+    {
+        // Paths like the resource database's keys, sharing long prefixes
+        list<string> keys;
+        list<string> missing_keys;
+        for ( usize i = 0; i < count; i++ )
+        {
+            keys.push_back( "resources/meshes/mesh_" + std::to_string( i ) + ".mesh" );
+            missing_keys.push_back( "resources/shaders/shader_" + std::to_string( i ) + ".shader" );
+        }
+        compare_dictionaries( keys, missing_keys );
+    }
+}
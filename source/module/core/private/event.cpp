@@ -11,36 +11,24 @@ namespace rnjin::core
     event_receiver::event_receiver() {}
     event_receiver::~event_receiver()
     {
-        // Free memory associated with this event_receiver's event handlers
-        // note: event_handler destructor is called to remove association with target event
-        for ( event_handler_base*& handler_pointer : owned_event_handlers )
+        // Remove this receiver's handlers from the events that still exist
+        // note: events subscribed to more than once are visited again, but their handlers are already gone by then
+        foreach ( subscribed_event : subscribed_events )
         {
-            delete handler_pointer;
-            // handler_pointer = nullptr;
+            subscribed_event->remove_handlers_of( *this );
         }
     }
-    // Free memory associated with this event_receiver's invalidated event handlers
-    void event_receiver::delete_invalid_event_handlers()
+
+    // Forget one handler's event, since the event is being destroyed
+    void event_receiver::forget_event( event_base& destroyed_event )
     {
-        for ( int i = 0; i < owned_event_handlers.size(); i++ )
+        for ( usize i = 0; i < subscribed_events.size(); i++ )
         {
-            event_handler_base* handler = owned_event_handlers[i];
-
-            // Do a quick removal of invalidated events
-            if ( not handler->has_valid_event() )
+            if ( subscribed_events[i] == &destroyed_event )
             {
-                // Move last element into the invalid element's slot
-                owned_event_handlers[i] = owned_event_handlers.back();
-
-                // Remove the extra copy of the last element
-                owned_event_handlers.pop_back();
-
-                // Delete the invalidated handler
-                delete handler;
-
-                // Decrement the iterator so we re-visit the same index,
-                // as it now holds a new value
-                i--;
+                subscribed_events[i] = subscribed_events.back();
+                subscribed_events.pop_back();
+                return;
             }
         }
     }
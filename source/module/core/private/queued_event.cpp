@@ -0,0 +1,18 @@
+/* *** ** *** ** *** ** *** *
+ * Part of rnjin            *
+ * (c) Rajin Shankar, 2019  *
+ *        rajinshankar.com  *
+ * *** ** *** ** *** ** *** */
+
+#include "queued_event.hpp"
+
+namespace rnjin::core
+{
+    // Get a small index for the calling thread, assigned the first time it asks
+    usize get_queue_thread_slot()
+    {
+        static std::atomic<usize> next_slot( 0 );
+        thread_local const usize slot = next_slot.fetch_add( 1, std::memory_order_relaxed );
+        return slot;
+    }
+} // namespace rnjin::core
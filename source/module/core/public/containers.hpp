@@ -8,11 +8,23 @@
 #include <rnjin.hpp>
 
 // STL data structures
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <new>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#    include <emmintrin.h>
+#endif
+#if defined( _MSC_VER )
+#    include <intrin.h>
+#endif
+
 // Aliases for STL types
 namespace rnjin
 {
@@ -83,11 +95,726 @@ namespace rnjin
     template <typename T>
     using list = std::vector<T>;
 
+    // A list that keeps up to inline_capacity elements inside itself, and only allocates once it grows past that
+    // ex. `small_list<handler*, 4> handlers;` never allocates for the first 4 handlers
+    // note: only holds trivially copyable elements (ex. pointers), which are moved around as plain bytes
+    template <typename T, usize inline_capacity>
+    class small_list
+    {
+        static_assert( std::is_trivially_copyable_v<T>, "small_list only holds trivially copyable elements" );
+
+        public: // methods
+        small_list() : elements( get_inline_elements() ), count( 0 ), capacity( inline_capacity ) {}
+        small_list( const small_list& other ) : small_list()
+        {
+            *this = other;
+        }
+        ~small_list()
+        {
+            release();
+        }
+
+        small_list& operator=( const small_list& other )
+        {
+            if ( this != &other )
+            {
+                reserve( other.count );
+                std::memcpy( elements, other.elements, other.count * sizeof( T ) );
+                count = other.count;
+            }
+            return *this;
+        }
+
+        void push_back( const T& value )
+        {
+            if ( count == capacity )
+            {
+                reserve( capacity * 2 );
+            }
+            elements[count] = value;
+            count += 1;
+        }
+        void pop_back()
+        {
+            count -= 1;
+        }
+        void clear()
+        {
+            count = 0;
+        }
+
+        // Make room for a total of new_capacity elements, moving them out of the inline storage if needed
+        void reserve( const usize new_capacity )
+        {
+            if ( new_capacity <= capacity )
+            {
+                return;
+            }
+
+            T* new_elements = static_cast<T*>( ::operator new( new_capacity * sizeof( T ) ) );
+            std::memcpy( new_elements, elements, count * sizeof( T ) );
+            release();
+            elements = new_elements;
+            capacity = new_capacity;
+        }
+
+        inline T& operator[]( const usize index )
+        {
+            return elements[index];
+        }
+        inline const T& operator[]( const usize index ) const
+        {
+            return elements[index];
+        }
+        inline T& back()
+        {
+            return elements[count - 1];
+        }
+
+        inline T* begin()
+        {
+            return elements;
+        }
+        inline T* end()
+        {
+            return elements + count;
+        }
+        inline const T* begin() const
+        {
+            return elements;
+        }
+        inline const T* end() const
+        {
+            return elements + count;
+        }
+
+        public: // accessors
+        inline usize size() const
+        {
+            return count;
+        }
+        inline bool empty() const
+        {
+            return count == 0;
+        }
+        inline usize get_capacity() const
+        {
+            return capacity;
+        }
+
+        private: // methods
+        inline T* get_inline_elements()
+        {
+            return reinterpret_cast<T*>( inline_storage );
+        }
+
+        // Free the elements if they've moved out of the inline storage
+        void release()
+        {
+            if ( elements != get_inline_elements() )
+            {
+                ::operator delete( elements );
+            }
+        }
+
+        private: // members
+        T* elements;
+        usize count;
+        usize capacity;
+        alignas( T ) byte inline_storage[sizeof( T ) * inline_capacity];
+    };
+
+    // An open addressing hash table keeping its slots in one flat array, so inserting never allocates on its own (only
+    // growing does) and lookups walk neighbouring memory
+    // note: base of flat_dictionary and flat_set (see dictionary and set), which hold either key-value pairs or keys
+    // note: each slot has a control byte, either empty or 7 bits of its key's hash, and lookups compare a group of 16
+    //       control bytes at once (with SSE2 where available) before comparing any keys
+    // note: slots are probed linearly from each key's home slot, and erasing shifts the following slots of the run back
+    //       into the gap, so there are no tombstones and lookups never slow down after many erases
+    // note: inserting or erasing can move slots, so it invalidates iterators and pointers to elements
+    template <typename K, typename slot_type, typename hash_type = std::hash<K>>
+    class flat_hash_table
+    {
+        public: // types
+        using key_type   = K;
+        using value_type = slot_type;
+
+        template <bool is_const>
+        class slot_iterator
+        {
+            private: // types
+            using table_type = std::conditional_t<is_const, const flat_hash_table, flat_hash_table>;
+            using slot_ref   = std::conditional_t<is_const, const slot_type&, slot_type&>;
+            using slot_ptr   = std::conditional_t<is_const, const slot_type*, slot_type*>;
+
+            public: // methods
+            slot_iterator( table_type* table, const usize index ) : pass_member( table ), pass_member( index ) {}
+            // Allow converting mutable iterators to const ones
+            operator slot_iterator<true>() const
+            {
+                return slot_iterator<true>( table, index );
+            }
+
+            inline slot_ref operator*() const
+            {
+                return table->slots[index];
+            }
+            inline slot_ptr operator->() const
+            {
+                return &table->slots[index];
+            }
+            inline slot_iterator& operator++()
+            {
+                index = table->get_next_full( index + 1 );
+                return *this;
+            }
+            inline bool operator==( const slot_iterator& other ) const
+            {
+                return index == other.index;
+            }
+            inline bool operator!=( const slot_iterator& other ) const
+            {
+                return index != other.index;
+            }
+
+            private: // members
+            friend flat_hash_table;
+
+            table_type* table;
+            usize index;
+        };
+        using iterator       = slot_iterator<false>;
+        using const_iterator = slot_iterator<true>;
+
+        public: // constants
+        static constexpr usize group_width = 16;
+
+        public: // methods
+        flat_hash_table() : controls( nullptr ), slots( nullptr ), capacity( 0 ), slot_count( 0 ) {}
+        flat_hash_table( std::initializer_list<slot_type> initial_slots ) : flat_hash_table()
+        {
+            reserve( initial_slots.size() );
+            foreach ( initial_slot : initial_slots )
+            {
+                insert( initial_slot );
+            }
+        }
+        flat_hash_table( const flat_hash_table& other ) : flat_hash_table()
+        {
+            *this = other;
+        }
+        flat_hash_table( flat_hash_table&& other ) : flat_hash_table()
+        {
+            *this = std::move( other );
+        }
+        ~flat_hash_table()
+        {
+            release();
+        }
+
+        flat_hash_table& operator=( const flat_hash_table& other )
+        {
+            if ( this != &other )
+            {
+                release();
+                if ( other.capacity > 0 )
+                {
+                    allocate( other.capacity );
+                    std::memcpy( controls, other.controls, capacity + group_width );
+                    for ( usize index = 0; index < capacity; index++ )
+                    {
+                        if ( is_full( index ) )
+                        {
+                            new ( &slots[index] ) slot_type( other.slots[index] );
+                        }
+                    }
+                    slot_count = other.slot_count;
+                }
+            }
+            return *this;
+        }
+        flat_hash_table& operator=( flat_hash_table&& other )
+        {
+            if ( this != &other )
+            {
+                release();
+                std::swap( controls, other.controls );
+                std::swap( slots, other.slots );
+                std::swap( capacity, other.capacity );
+                std::swap( slot_count, other.slot_count );
+            }
+            return *this;
+        }
+
+        // Add a slot if no slot with its key exists yet, returning the slot with that key and whether it was added
+        std::pair<iterator, bool> insert( const slot_type& new_slot )
+        {
+            let added = find_or_prepare_insert( get_key( new_slot ) );
+            if ( added.second )
+            {
+                new ( &slots[added.first] ) slot_type( new_slot );
+            }
+            return { iterator( this, added.first ), added.second };
+        }
+
+        // Remove the slot with a key, returning the number of slots removed (0 or 1)
+        usize erase( const K& key )
+        {
+            let index = find_index( key );
+            if ( index == capacity )
+            {
+                return 0;
+            }
+            erase_at( index );
+            return 1;
+        }
+        // Remove the slot an iterator points to
+        // note: later slots can be moved into its place, so erasing while iterating over the table isn't supported
+        void erase( const const_iterator position )
+        {
+            erase_at( position.index );
+        }
+
+        void clear()
+        {
+            if ( slot_count > 0 )
+            {
+                destroy_slots();
+                std::memset( controls, empty_control, capacity + group_width );
+                slot_count = 0;
+            }
+        }
+
+        // Make room for a total of new_count slots without growing again
+        void reserve( const usize new_count )
+        {
+            usize new_capacity = capacity == 0 ? group_width : capacity;
+            while ( new_count > get_max_count( new_capacity ) )
+            {
+                new_capacity *= 2;
+            }
+            if ( new_capacity > capacity )
+            {
+                rehash( new_capacity );
+            }
+        }
+
+        iterator find( const K& key )
+        {
+            return iterator( this, find_index( key ) );
+        }
+        const_iterator find( const K& key ) const
+        {
+            return const_iterator( this, find_index( key ) );
+        }
+        // Get the number of slots with a key (0 or 1)
+        usize count( const K& key ) const
+        {
+            return find_index( key ) == capacity ? 0 : 1;
+        }
+
+        iterator begin()
+        {
+            return iterator( this, get_next_full( 0 ) );
+        }
+        iterator end()
+        {
+            return iterator( this, capacity );
+        }
+        const_iterator begin() const
+        {
+            return const_iterator( this, get_next_full( 0 ) );
+        }
+        const_iterator end() const
+        {
+            return const_iterator( this, capacity );
+        }
+
+        public: // accessors
+        inline usize size() const
+        {
+            return slot_count;
+        }
+        inline bool empty() const
+        {
+            return slot_count == 0;
+        }
+        inline usize get_capacity() const
+        {
+            return capacity;
+        }
+
+        protected: // methods
+        // Find the slot with a key, or prepare an empty slot for it (growing if needed), returning its index and whether
+        // it was prepared, in which case the caller must construct the slot
+        std::pair<usize, bool> find_or_prepare_insert( const K& key )
+        {
+            let hash  = get_hash( key );
+            let found = find_index( key, hash );
+            if ( found != capacity )
+            {
+                return { found, false };
+            }
+
+            if ( slot_count + 1 > get_max_count( capacity ) )
+            {
+                rehash( capacity == 0 ? group_width : capacity * 2 );
+            }
+            let index = find_empty( hash );
+            set_control( index, get_control( hash ) );
+            slot_count += 1;
+            return { index, true };
+        }
+
+        // Get the index of the slot with a key, or capacity if there is none
+        usize find_index( const K& key ) const
+        {
+            return slot_count == 0 ? capacity : find_index( key, get_hash( key ) );
+        }
+
+        inline slot_type& get_slot( const usize index )
+        {
+            return slots[index];
+        }
+        inline const slot_type& get_slot( const usize index ) const
+        {
+            return slots[index];
+        }
+
+        private: // types
+        // A group of control bytes starting at any slot, compared all at once
+        // note: match results have one bit for each control byte in the group, lowest first
+        class control_group
+        {
+            public: // methods
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+            inline control_group( const byte* first ) : bytes( _mm_loadu_si128( reinterpret_cast<const __m128i*>( first ) ) ) {}
+
+            inline uint match( const byte control ) const
+            {
+                return (uint) _mm_movemask_epi8( _mm_cmpeq_epi8( bytes, _mm_set1_epi8( (char) control ) ) );
+            }
+            // note: only empty control bytes have their high bit set
+            inline uint match_empty() const
+            {
+                return (uint) _mm_movemask_epi8( bytes );
+            }
+
+            private: // members
+            __m128i bytes;
+#else
+            inline control_group( const byte* first ) : pass_member( first ) {}
+
+            inline uint match( const byte control ) const
+            {
+                uint result = 0;
+                for ( usize i = 0; i < group_width; i++ )
+                {
+                    result |= uint( first[i] == control ) << i;
+                }
+                return result;
+            }
+            inline uint match_empty() const
+            {
+                return match( empty_control );
+            }
+
+            private: // members
+            const byte* first;
+#endif
+        };
+
+        private: // constants
+        static constexpr byte empty_control = 0x80;
+
+        private: // methods
+        // Mix a key's hash, since standard hashes of integers and pointers are often the values themselves
+        // note: the home slot is taken from the low bits (folded with the high ones), and the control byte from the top 7
+        static inline uint64 get_hash( const K& key )
+        {
+            return uint64( hash_type()( key ) ) * 0x9E3779B97F4A7C15ull;
+        }
+        inline usize get_home( const uint64 hash ) const
+        {
+            return usize( hash ^ ( hash >> 32 ) ) & ( capacity - 1 );
+        }
+        static inline byte get_control( const uint64 hash )
+        {
+            return byte( hash >> 57 );
+        }
+        static inline const K& get_key( const slot_type& slot )
+        {
+            if constexpr ( std::is_same_v<slot_type, K> )
+            {
+                return slot;
+            }
+            else
+            {
+                return slot.first;
+            }
+        }
+        // Tables are kept at most 7/8 full, which keeps runs of full slots short enough for lookups to rarely leave
+        // their first group, while keeping the table small enough to stay in cache
+        static inline usize get_max_count( const usize table_capacity )
+        {
+            return table_capacity - table_capacity / 8;
+        }
+        static inline uint get_lowest_bit( const uint bits )
+        {
+#if defined( _MSC_VER )
+            unsigned long index;
+            _BitScanForward( &index, bits );
+            return (uint) index;
+#else
+            return (uint) __builtin_ctz( bits );
+#endif
+        }
+
+        inline bool is_full( const usize index ) const
+        {
+            return controls[index] != empty_control;
+        }
+        // Set a control byte, and its copy past the end, which lets groups starting near the end wrap around
+        inline void set_control( const usize index, const byte control )
+        {
+            controls[index] = control;
+            if ( index < group_width - 1 )
+            {
+                controls[capacity + index] = control;
+            }
+        }
+
+        usize find_index( const K& key, const uint64 hash ) const
+        {
+            if ( capacity == 0 )
+            {
+                return capacity;
+            }
+
+            let mask    = capacity - 1;
+            let control = get_control( hash );
+            for ( usize first = get_home( hash );; first = ( first + group_width ) & mask )
+            {
+                let controls_group = control_group( controls + first );
+                for ( uint matches = controls_group.match( control ); matches != 0; matches &= matches - 1 )
+                {
+                    let index = ( first + get_lowest_bit( matches ) ) & mask;
+                    if ( get_key( slots[index] ) == key )
+                    {
+                        return index;
+                    }
+                }
+
+                // Keys are never stored past an empty slot in their run
+                if ( controls_group.match_empty() != 0 )
+                {
+                    return capacity;
+                }
+            }
+        }
+
+        // Find the first empty slot at or after a hash's home slot
+        usize find_empty( const uint64 hash ) const
+        {
+            let mask = capacity - 1;
+            for ( usize first = get_home( hash );; first = ( first + group_width ) & mask )
+            {
+                let empties = control_group( controls + first ).match_empty();
+                if ( empties != 0 )
+                {
+                    return ( first + get_lowest_bit( empties ) ) & mask;
+                }
+            }
+        }
+
+        // Find the first full slot at or after an index, or capacity if there is none
+        usize get_next_full( const usize index ) const
+        {
+            constexpr uint group_bits = ( 1u << group_width ) - 1;
+            for ( usize first = index; first < capacity; first += group_width )
+            {
+                // note: bytes past the end are copies of the first ones, which give indices past capacity here
+                let fulls = ~control_group( controls + first ).match_empty() & group_bits;
+                if ( fulls != 0 )
+                {
+                    return std::min( first + get_lowest_bit( fulls ), capacity );
+                }
+            }
+            return capacity;
+        }
+
+        // Remove a slot, then move later slots of its run back into the gap, as long as that doesn't move them before
+        // their home slot
+        void erase_at( const usize index )
+        {
+            let mask = capacity - 1;
+            slots[index].~slot_type();
+            slot_count -= 1;
+
+            usize gap = index;
+            for ( usize next = ( index + 1 ) & mask; is_full( next ); next = ( next + 1 ) & mask )
+            {
+                let home = get_home( get_hash( get_key( slots[next] ) ) );
+                if ( ( ( next - home ) & mask ) >= ( ( next - gap ) & mask ) )
+                {
+                    new ( &slots[gap] ) slot_type( std::move( slots[next] ) );
+                    slots[next].~slot_type();
+                    set_control( gap, controls[next] );
+                    gap = next;
+                }
+            }
+            set_control( gap, empty_control );
+        }
+
+        // Move every slot into new arrays with a given capacity
+        void rehash( const usize new_capacity )
+        {
+            let* old_controls      = controls;
+            let_mutable* old_slots = slots;
+            let old_capacity       = capacity;
+
+            allocate( new_capacity );
+            for ( usize index = 0; index < old_capacity; index++ )
+            {
+                if ( old_controls[index] != empty_control )
+                {
+                    let hash      = get_hash( get_key( old_slots[index] ) );
+                    let new_index = find_empty( hash );
+                    set_control( new_index, get_control( hash ) );
+                    new ( &slots[new_index] ) slot_type( std::move( old_slots[index] ) );
+                    old_slots[index].~slot_type();
+                }
+            }
+
+            ::operator delete( (void*) old_controls );
+            ::operator delete( (void*) old_slots );
+        }
+
+        // Allocate empty arrays with a given capacity (a power of 2), without freeing the current ones
+        void allocate( const usize new_capacity )
+        {
+            capacity = new_capacity;
+            controls = static_cast<byte*>( ::operator new( capacity + group_width ) );
+            slots    = static_cast<slot_type*>( ::operator new( capacity * sizeof( slot_type ) ) );
+            std::memset( controls, empty_control, capacity + group_width );
+        }
+
+        void destroy_slots()
+        {
+            if constexpr ( not std::is_trivially_destructible_v<slot_type> )
+            {
+                for ( usize index = 0; index < capacity; index++ )
+                {
+                    if ( is_full( index ) )
+                    {
+                        slots[index].~slot_type();
+                    }
+                }
+            }
+        }
+
+        void release()
+        {
+            if ( capacity > 0 )
+            {
+                destroy_slots();
+                ::operator delete( controls );
+                ::operator delete( slots );
+            }
+            controls = nullptr;
+            slots    = nullptr;
+            capacity   = 0;
+            slot_count = 0;
+        }
+
+        private: // members
+        byte* controls;
+        slot_type* slots;
+        usize capacity;
+        usize slot_count;
+    };
+
+    // A flat hash table of values by key (see flat_hash_table)
+    // note: elements are key-value pairs, like in standard maps, but their keys must not be changed through iterators
+    template <typename K, typename V, typename hash_type = std::hash<K>>
+    class flat_dictionary : public flat_hash_table<K, std::pair<K, V>, hash_type>
+    {
+        private: // types
+        using base = flat_hash_table<K, std::pair<K, V>, hash_type>;
+
+        public: // types
+        using mapped_type = V;
+        using typename base::const_iterator;
+        using typename base::iterator;
+
+        public: // methods
+        using base::base;
+
+        // Get the value with a key, adding a default one if there is none
+        V& operator[]( const K& key )
+        {
+            let added = base::find_or_prepare_insert( key );
+            if ( added.second )
+            {
+                new ( &base::get_slot( added.first ) ) std::pair<K, V>( key, V() );
+            }
+            return base::get_slot( added.first ).second;
+        }
+
+        // Get the value with a key
+        // note: the key must be in the dictionary (ie. check count first)
+        V& at( const K& key )
+        {
+            return base::get_slot( base::find_index( key ) ).second;
+        }
+        const V& at( const K& key ) const
+        {
+            return base::get_slot( base::find_index( key ) ).second;
+        }
+
+        // Add a value with a key if there isn't one yet, returning the element with that key and whether it was added
+        std::pair<iterator, bool> emplace( const K& key, const V& value )
+        {
+            let added = base::find_or_prepare_insert( key );
+            if ( added.second )
+            {
+                new ( &base::get_slot( added.first ) ) std::pair<K, V>( key, value );
+            }
+            return { iterator( this, added.first ), added.second };
+        }
+
+        // Set the value with a key, adding it if there isn't one yet
+        std::pair<iterator, bool> insert_or_assign( const K& key, const V& value )
+        {
+            let added = base::find_or_prepare_insert( key );
+            if ( added.second )
+            {
+                new ( &base::get_slot( added.first ) ) std::pair<K, V>( key, value );
+            }
+            else
+            {
+                base::get_slot( added.first ).second = value;
+            }
+            return { iterator( this, added.first ), added.second };
+        }
+    };
+
+    // A flat hash table of unique values (see flat_hash_table)
+    template <typename T, typename hash_type = std::hash<T>>
+    class flat_set : public flat_hash_table<T, T, hash_type>
+    {
+        private: // types
+        using base = flat_hash_table<T, T, hash_type>;
+
+        public: // methods
+        using base::base;
+    };
+
     template <typename K, typename V>
-    using dictionary = std::unordered_map<K, V>;
+    using dictionary = flat_dictionary<K, V>;
 
     template <typename T>
-    using set = std::unordered_set<T>;
+    using set = flat_set<T>;
 
     // range for python-style for( uint i : range(0, 10) )
     // note: only supports 32-bit unsigned values
@@ -7,6 +7,10 @@
 #pragma once
 #include <rnjin.hpp>
 
+#include <atomic>
+#include <mutex>
+#include <thread>
+
 #include "macro.hpp"
 #include "containers.hpp"
 
@@ -14,232 +18,460 @@
 
 namespace rnjin::core
 {
-    // Forward declaration of the event class
+    // Forward declaration of the event classes
     template <typename... As>
     class event;
+    template <typename... As>
+    class concurrent_event;
+    class event_base;
 
-    // Base type of event handlers for external use
-    // note: used so objects can store references to
-    //       their owned event handlers without
-    //       knowing their exact type
-    class event_handler_base
+    // Something that adds handlers to events, and needs to be told when one of those events is destroyed
+    // note: used so events can reach whoever added each handler without knowing their exact type
+    class event_subscriber
     {
         public: // methods
-        virtual ~event_handler_base() pure_virtual{};
-        virtual bool has_valid_event() pure_virtual;
+        virtual ~event_subscriber() {}
+
+        protected: // methods
+        template <typename... As>
+        friend class event;
+        template <typename... As>
+        friend class concurrent_event;
+
+        // Forget an event this subscriber added a handler to, since it's being destroyed
+        // note: called once for each of the subscriber's handlers in the event
+        virtual void forget_event( event_base& destroyed_event ) pure_virtual;
     };
 
-    // Base type of event handlers as known by an event
-    // note: used so the event can call the invoke method properly
-    template <typename... As>
-    class event_handler_args
+    // Base type of events, so subscribers can remove their handlers without knowing an event's exact type
+    class event_base
     {
         public: // methods
-        virtual ~event_handler_args() pure_virtual{};
+        virtual ~event_base() {}
 
-        virtual void invoke( As... args ) pure_virtual;
-        virtual void invalidate_event() pure_virtual;
+        // Remove every handler added by a subscriber
+        virtual void remove_handlers_of( event_subscriber& subscriber ) pure_virtual;
     };
 
-    // Actual event handler type that stores an instance and an instance method
-    // note: event handlers are invalidated with their target event is destroyed,
-    //       but are not themselves destroyed (ie still take up memory)
-    // note: invalidated event handlers owned by objects are destroyed periodically
-    //       in event_receiver::delete_invalid_event_handlers()
+    // A handler as stored by an event: an instance, a function that calls a method on it, and whoever added it
+    // note: plain data, so events keep their handlers inline in a flat list, adding one never allocates on its own,
+    //       and calling one is a single indirect call
+    template <typename... As>
+    struct event_delegate
+    {
+        using invoke_type = void ( * )( const event_delegate&, As... );
+
+        // Room for the method pointer, since pointers to methods of classes with multiple or virtual bases are larger
+        // than plain function pointers on some compilers
+        static constexpr usize max_method_size = 4 * sizeof( void* );
+
+        // Make a delegate that calls a method on an instance
+        template <typename O>
+        static event_delegate bind( O* instance, void ( O::*method )( As... ), event_subscriber* subscriber )
+        {
+            using method_type = void ( O::* )( As... );
+            static_assert( sizeof( method_type ) <= max_method_size, "Method pointer is too large for an event delegate" );
+
+            event_delegate result;
+            result.instance   = instance;
+            result.invoke     = &invoke_method<O>;
+            result.subscriber = subscriber;
+            std::memcpy( result.method, &method, sizeof( method_type ) );
+            return result;
+        }
+
+        // Make a delegate that calls a function
+        static event_delegate bind( void ( *function )( As... ), event_subscriber* subscriber )
+        {
+            event_delegate result;
+            result.instance   = nullptr;
+            result.invoke     = &invoke_function;
+            result.subscriber = subscriber;
+            std::memcpy( result.method, &function, sizeof( function ) );
+            return result;
+        }
+
+        inline void operator()( As... args ) const
+        {
+            invoke( *this, args... );
+        }
+
+        template <typename O>
+        static void invoke_method( const event_delegate& target, As... args )
+        {
+            void ( O::*method )( As... );
+            std::memcpy( &method, target.method, sizeof( method ) );
+            ( static_cast<O*>( target.instance )->*method )( args... );
+        }
+        static void invoke_function( const event_delegate& target, As... args )
+        {
+            void ( *function )( As... );
+            std::memcpy( &function, target.method, sizeof( function ) );
+            function( args... );
+        }
+
+        void* instance;
+        invoke_type invoke;
+        event_subscriber* subscriber;
+        alignas( void* ) byte method[max_method_size];
+    };
+
+    // A handler that calls a method on an instance for as long as it exists
+    // ex. `let handler = event_handler( clicked_event, &button, &button::on_clicked );`
+    // note: handlers outliving their event are left without one (see has_valid_event)
     template <typename O, typename... As>
-    class event_handler : public event_handler_base, public event_handler_args<As...>
+    class event_handler : public event_subscriber
     {
         private: // types
-        using event_type  = event<As...>;
         using method_type = void ( O::* )( As... );
 
         public: // methods
         // Register this handler with the target event on creation
-        event_handler( event_type& target_event, O* instance, method_type method ) : target_event( &target_event ), pass_member( instance ), pass_member( method )
+        event_handler( event<As...>& target_event, O* instance, method_type method ) : target_event( &target_event )
         {
-            target_event.add_handler( this );
+            target_event.add_handler( event_delegate<As...>::bind( instance, method, this ) );
+        }
+        event_handler( concurrent_event<As...>& target_event, O* instance, method_type method ) : target_event( &target_event )
+        {
+            target_event.add_handler( event_delegate<As...>::bind( instance, method, this ) );
         }
         // Remove this handler from the target event if it still exists
         ~event_handler()
         {
             if ( target_event != nullptr )
             {
-                target_event->remove_handler( this );
+                target_event->remove_handlers_of( *this );
             }
         }
+        no_copy( event_handler );
 
-        // Call the handlers method on its instance
-        void invoke( As... args ) override
+        // Check if this handler is still associated with an event
+        bool has_valid_event() const
         {
-            // instance->*method( args... );
-            std::invoke( method, instance, args... );
+            return target_event != nullptr;
         }
 
-        // Clear the target event pointer so it isn't improperly dereferenced during destruction
-        // note: called from the event's destructor (ie when a handler outlives its event)
-        void invalidate_event()
+        protected: // inherited
+        void forget_event( event_base& destroyed_event ) override
         {
             target_event = nullptr;
         }
 
-        // Check if this handler is still associated with an event
-        // note: handlers without valid events can be freely deleted
-        bool has_valid_event()
-        {
-            return target_event != nullptr;
-        }
-
         private: // members
-        event_type* target_event;
-        O* instance;
-        method_type method;
+        event_base* target_event;
     };
 
+    // A handler that calls a function for as long as it exists
     template <typename... As>
-    class static_event_handler : public event_handler_base, public event_handler_args<As...>
+    class static_event_handler : public event_subscriber
     {
         private: // types
         using event_type    = event<As...>;
         using function_type = void ( * )( As... );
 
         public: // methods
-        static_event_handler() : target_event( nullptr ), function( nullptr )
-        {
-            this->function = nullptr;
-        }
+        static_event_handler() : target_event( nullptr ) {}
 
         // Register this handler with the target event on creation
-        static_event_handler( event_type& target_event, function_type function ) : target_event( &target_event ), pass_member( function )
+        static_event_handler( event_type& target_event, function_type function ) : static_event_handler()
         {
-            target_event.add_handler( this );
+            set( target_event, function );
         }
         // Remove this handler from the target event if it still exists
         ~static_event_handler()
         {
             if ( target_event != nullptr )
             {
-                target_event->remove_handler( this );
+                target_event->remove_handlers_of( *this );
             }
         }
+        no_copy( static_event_handler );
 
         void set( event_type& new_target_event, function_type new_function )
         {
             if ( target_event != nullptr )
             {
-                target_event->remove_handler( this );
+                target_event->remove_handlers_of( *this );
             }
 
             target_event = &new_target_event;
-            function     = new_function;
-
-            if ( target_event != nullptr )
-            {
-                target_event->add_handler( this );
-            }
+            target_event->add_handler( event_delegate<As...>::bind( new_function, this ) );
         }
 
-        // Call the handlers method on its instance
-        void invoke( As... args ) override
+        // Check if this handler is still associated with an event
+        bool has_valid_event() const
         {
-            function( args... );
+            return target_event != nullptr;
         }
 
-        // Clear the target event pointer so it isn't improperly dereferenced during destruction
-        // note: called from the event's destructor (ie when a handler outlives its event)
-        void invalidate_event()
+        protected: // inherited
+        void forget_event( event_base& destroyed_event ) override
         {
             target_event = nullptr;
         }
 
-        // Check if this handler is still associated with an event
-        // note: handlers without valid events can be freely deleted
-        bool has_valid_event()
-        {
-            return target_event != nullptr;
-        }
-
         private: // members
         event_type* target_event;
-        function_type function;
     };
 
     // An event source (ie publisher, delegate, etc.)
+    // note: handlers are kept inline in a flat list, so sending is a linear walk over it with one indirect call per
+    //       handler, and events with up to inline_handler_count handlers never allocate
+    // note: handlers are called in the order they were added, except that removing a handler moves the last one into its
+    //       place
+    // note: handlers can't be added to or removed from an event while it's sending (see concurrent_event for events
+    //       sent and subscribed to from several threads)
     template <typename... As>
-    class event
+    class event : public event_base
     {
-        private: // types
-        using handler_type = event_handler_args<As...>;
+        public: // types
+        using delegate_type = event_delegate<As...>;
+
+        public: // constants
+        static constexpr usize inline_handler_count = 4;
 
         public: // methods
         event( const string& name ) : pass_member( name ) {}
 
-        // Invalidate all handlers for this event when it is destroyed
-        // note: invalidated handlers still reside in memory and need to be freed elsewhere
+        // Tell the subscriber of each handler that this event is gone, so they don't try to remove them later
         ~event()
         {
-            foreach ( handler_pointer : handler_pointers )
+            foreach ( handler : handlers )
             {
-                handler_pointer->invalidate_event();
+                if ( handler.subscriber != nullptr )
+                {
+                    handler.subscriber->forget_event( *this );
+                }
             }
         }
 
         // Register a handler with this event
-        // note: called from event_handler constructor
-        void add_handler( handler_type* new_handler_pointer )
+        // note: called from event_handler constructor and event_receiver::handle_event
+        void add_handler( const delegate_type& new_handler )
         {
-            handler_pointers.insert( new_handler_pointer );
+            handlers.push_back( new_handler );
         }
 
-        // Remove a handler from this event
-        // note: called from event_handler destructor
-        void remove_handler( handler_type* handler_pointer )
+        // Remove every handler added by a subscriber, moving the last handlers into their slots
+        // note: called when a handler or event_receiver is destroyed, and only walks this event's handlers
+        void remove_handlers_of( event_subscriber& subscriber ) override
         {
-            handler_pointers.erase( handler_pointer );
+            for ( usize i = 0; i < handlers.size(); )
+            {
+                if ( handlers[i].subscriber == &subscriber )
+                {
+                    handlers[i] = handlers.back();
+                    handlers.pop_back();
+                }
+                else
+                {
+                    i++;
+                }
+            }
         }
 
         // Invoke all handlers associated with this event
         void send( As... args ) const
         {
-            foreach ( handler_pointer : handler_pointers )
+            foreach ( handler : handlers )
             {
-                handler_pointer->invoke( args... );
+                handler( args... );
             }
         }
 
         public: // accessors
         let& get_name get_value( name );
+        // Check if any handlers are registered, so senders can skip preparing arguments nobody will see
+        let has_handlers get_value( not handlers.empty() );
 
         private: // members
         string name;
-        set<handler_type*> handler_pointers;
+        small_list<delegate_type, inline_handler_count> handlers;
+    };
+
+    // An event source that can be sent from any number of threads while handlers are added and removed from others
+    // ex. `concurrent_event<const job&> job_finished( "job finished" );`, sent from worker threads
+    // note: handlers are kept in an immutable snapshot, which send reads without locking or waiting (two atomic counter
+    //       updates and an atomic load), and which adding or removing a handler replaces with an updated copy
+    // note: replaced snapshots are only freed once every send that could still be reading them has finished, so once
+    //       remove_handlers_of returns (ex. when a handler is destroyed) its handler will not be called again
+    // note: adding and removing handlers is comparatively slow (it copies the handlers, and waits for sends in progress),
+    //       so this is meant for events subscribed to rarely and sent often
+    // note: handlers can't add or remove handlers of the event calling them, since that would wait on their own send
+    template <typename... As>
+    class concurrent_event : public event_base
+    {
+        public: // types
+        using delegate_type = event_delegate<As...>;
+
+        public: // methods
+        concurrent_event( const string& name ) : pass_member( name ), handlers( nullptr ), read_phase( 0 )
+        {
+            readers[0].count.store( 0 );
+            readers[1].count.store( 0 );
+        }
+
+        // Tell the subscriber of each handler that this event is gone, so they don't try to remove them later
+        // note: the event must not be sending while it's destroyed
+        ~concurrent_event()
+        {
+            let* current = handlers.load();
+            if ( current != nullptr )
+            {
+                foreach ( handler : *current )
+                {
+                    if ( handler.subscriber != nullptr )
+                    {
+                        handler.subscriber->forget_event( *this );
+                    }
+                }
+            }
+            delete current;
+        }
+        no_copy( concurrent_event );
+
+        // Register a handler with this event
+        // note: called from event_handler constructor and event_receiver::handle_event
+        void add_handler( const delegate_type& new_handler )
+        {
+            std::lock_guard<std::mutex> lock( write_lock );
+
+            let* current         = handlers.load();
+            handler_list* copied = current == nullptr ? new handler_list() : new handler_list( *current );
+            copied->push_back( new_handler );
+            publish( copied );
+        }
+
+        // Remove every handler added by a subscriber, waiting for sends that could still be calling them
+        void remove_handlers_of( event_subscriber& subscriber ) override
+        {
+            std::lock_guard<std::mutex> lock( write_lock );
+
+            let* current = handlers.load();
+            if ( current == nullptr )
+            {
+                return;
+            }
+
+            handler_list* copied = new handler_list();
+            copied->reserve( current->size() );
+            foreach ( handler : *current )
+            {
+                if ( handler.subscriber != &subscriber )
+                {
+                    copied->push_back( handler );
+                }
+            }
+
+            if ( copied->empty() )
+            {
+                delete copied;
+                copied = nullptr;
+            }
+            publish( copied );
+        }
+
+        // Invoke all handlers associated with this event, as of the start of the call
+        void send( As... args ) const
+        {
+            // Count this send as a reader of the current phase, so snapshots it reads aren't freed until it's done
+            let phase = read_phase.load();
+            readers[phase].count.fetch_add( 1 );
+
+            let* current = handlers.load();
+            if ( current != nullptr )
+            {
+                foreach ( handler : *current )
+                {
+                    handler( args... );
+                }
+            }
+
+            readers[phase].count.fetch_sub( 1 );
+        }
+
+        public: // accessors
+        let& get_name get_value( name );
+        // Check if any handlers are registered, so senders can skip preparing arguments nobody will see
+        let has_handlers get_value( handlers.load() != nullptr );
+
+        private: // types
+        using handler_list = list<delegate_type>;
+
+        // A count of sends in progress, on its own cache line so sends on different threads don't contend with writers
+        struct alignas( 64 ) reader_count
+        {
+            std::atomic<usize> count;
+        };
+
+        private: // methods
+        // Replace the current handlers, then free the old ones once no send can still be reading them
+        // note: every send that could have read the old handlers counted itself (in one of the phases) before the
+        //       handlers were replaced, so waiting for both phases to empty is enough
+        // note: sends starting after a flip count themselves in the other phase, so each wait only waits for sends
+        //       already in progress, and finishes even while more are being sent
+        void publish( handler_list* new_handlers )
+        {
+            let* old_handlers = handlers.exchange( new_handlers );
+
+            for ( usize flip = 0; flip < 2; flip++ )
+            {
+                let old_phase = read_phase.load();
+                read_phase.store( old_phase ^ 1 );
+                while ( readers[old_phase].count.load() != 0 )
+                {
+                    std::this_thread::yield();
+                }
+            }
+
+            delete old_handlers;
+        }
+
+        private: // members
+        string name;
+
+        // The current handlers, or nullptr if there are none
+        std::atomic<const handler_list*> handlers;
+
+        // Sends in progress, split in two phases so writers can wait for the ones that started before a change
+        mutable reader_count readers[2];
+        std::atomic<usize> read_phase;
+
+        // Held while adding or removing handlers, so changes aren't lost by copying the same snapshot
+        std::mutex write_lock;
     };
 
     // A base helper class for types that will do lots of event handling
-    class event_receiver
+    // note: handlers are stored in the events themselves, and removed from them when the receiver is destroyed, so
+    //       handling an event never allocates on its own and receivers never need to clean up after destroyed events
+    class event_receiver : public event_subscriber
     {
         public: // methods
         event_receiver();
         ~event_receiver();
 
-        // Create a new event handler for the target event
-        // and store it as an owned event handlers of this event_receiver
+        // Add a handler calling a method of this receiver to the target event, for as long as the receiver exists
+        // note: a C-style cast, since receivers can derive from event_receiver privately
         template <typename O, typename... As>
         void handle_event( event<As...>& target_event, void ( O::*method )( As... ) )
         {
-            event_handler<O, As...>* new_event_handler = new event_handler<O, As...>( target_event, (O*) this, method );
-            owned_event_handlers.push_back( new_event_handler );
-
-            // Clean up any invalid handler pointers whenever a new one is added
-            // note: this could happen any time, but this seems to make sense
-            delete_invalid_event_handlers();
+            target_event.add_handler( event_delegate<As...>::bind( (O*) this, method, this ) );
+            subscribed_events.push_back( &target_event );
+        }
+        // note: the receiver itself isn't synchronized, so each receiver should handle events from one thread at a time
+        template <typename O, typename... As>
+        void handle_event( concurrent_event<As...>& target_event, void ( O::*method )( As... ) )
+        {
+            target_event.add_handler( event_delegate<As...>::bind( (O*) this, method, this ) );
+            subscribed_events.push_back( &target_event );
         }
 
-        // Go through all event handlers and free ones that don't have a
-        // valid target event (ie handlers for destroyed events)
-        void delete_invalid_event_handlers();
+        protected: // inherited
+        void forget_event( event_base& destroyed_event ) override;
 
         private: // members
-        list<event_handler_base*> owned_event_handlers;
+        // Events this receiver has added handlers to, once per handler
+        small_list<event_base*, 4> subscribed_events;
     };
 
     // A base helper class for types that need others to know about their lifetime
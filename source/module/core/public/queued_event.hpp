@@ -0,0 +1,166 @@
+/* *** ** *** ** *** ** *** *
+ * Part of rnjin            *
+ * (c) Rajin Shankar, 2019  *
+ *        rajinshankar.com  *
+ * *** ** *** ** *** ** *** */
+
+#pragma once
+#include <rnjin.hpp>
+
+#include <atomic>
+#include <mutex>
+#include <type_traits>
+
+#include "macro.hpp"
+#include "containers.hpp"
+#include "event.hpp"
+
+// note: not included from core/module.h, since event.hpp includes core/module.h (through the log module) before it
+//       defines event
+
+namespace rnjin::core
+{
+    // Get a small index for the calling thread, assigned the first time it asks
+    // note: used by queued events to give each sending thread its own buffer
+    usize get_queue_thread_slot();
+
+    // An event whose payloads are queued as they're sent, and handed to handlers later, all at once, by dispatch
+    // ex. `queued_event<entity_id> despawned( "despawned" );`, `despawned.send( id );` from any thread, then
+    //     `despawned.dispatch();` once per frame, which sends `despawned.dispatched()` with every id queued since the last one
+    // note: sending only copies the payload into a buffer belonging to the sending thread, so senders never run handlers
+    //       or wait for each other, and events can be sent from worker threads
+    // note: buffers are double-buffered, ie. dispatching swaps each one for an empty one, so threads can keep sending
+    //       while handlers run (and payloads sent by handlers arrive with the next dispatch)
+    // note: payloads are delivered grouped by sending thread, in the order each thread sent them
+    template <typename T>
+    class queued_event
+    {
+        static_assert( std::is_trivially_copyable_v<T>, "Queued event payloads must be trivially copyable" );
+
+        public: // constants
+        // Number of separate buffers; threads beyond this share them (safely, just not contention-free)
+        static constexpr usize max_buffer_count = 64;
+
+        public: // methods
+        queued_event( const string& name ) : pass_member( name ), dispatched_event( name )
+        {
+            for ( usize i = 0; i < max_buffer_count; i++ )
+            {
+                buffers[i].store( nullptr, std::memory_order_relaxed );
+            }
+        }
+        ~queued_event()
+        {
+            for ( usize i = 0; i < max_buffer_count; i++ )
+            {
+                delete buffers[i].load( std::memory_order_relaxed );
+            }
+        }
+        no_copy( queued_event );
+
+        // Queue a payload, to be handed to handlers by the next dispatch
+        void send( const T& payload )
+        {
+            let_mutable& buffer = get_thread_buffer();
+            std::lock_guard<std::mutex> lock( buffer.lock );
+            buffer.queued.push_back( payload );
+        }
+
+        // Hand every payload queued since the last dispatch to the handlers of dispatched(), returning how many there were
+        // note: handlers run on the calling thread, once per dispatch with all payloads (and not at all if there were none)
+        // note: no lock is held while handlers run, so they can dispatch again (ex. freeing a resource that drops the last
+        //       reference to another, and flushing it right away)
+        usize dispatch()
+        {
+            list<T> batch;
+            subregion
+            {
+                std::lock_guard<std::mutex> lock( dispatch_lock );
+
+                // Reuse the capacity of an earlier batch
+                batch.swap( spare_batch );
+                for ( usize i = 0; i < max_buffer_count; i++ )
+                {
+                    let_mutable* buffer = buffers[i].load( std::memory_order_acquire );
+                    if ( buffer == nullptr )
+                    {
+                        continue;
+                    }
+
+                    // Swap the buffer's payloads out, so its thread can keep sending while they're copied into the batch
+                    subregion
+                    {
+                        std::lock_guard<std::mutex> buffer_lock( buffer->lock );
+                        buffer->queued.swap( buffer->taken );
+                    }
+                    batch.insert( batch.end(), buffer->taken.begin(), buffer->taken.end() );
+                    buffer->taken.clear();
+                }
+            }
+
+            let count = batch.size();
+            if ( count > 0 )
+            {
+                dispatched_event.send( batch );
+            }
+
+            // Keep the batch's capacity for the next dispatch, unless a nested dispatch left a larger one
+            subregion
+            {
+                std::lock_guard<std::mutex> lock( dispatch_lock );
+                if ( batch.capacity() > spare_batch.capacity() )
+                {
+                    batch.clear();
+                    spare_batch.swap( batch );
+                }
+            }
+            return count;
+        }
+
+        public: // accessors
+        let& get_name get_value( name );
+        // The event sent by dispatch with every queued payload
+        let_mutable& dispatched get_mutable_value( dispatched_event );
+
+        private: // types
+        // Payloads sent by one thread
+        // note: taken is only touched by the dispatching thread, and keeps its capacity for the next swap
+        struct thread_buffer
+        {
+            std::mutex lock;
+            list<T> queued;
+            list<T> taken;
+        };
+
+        private: // methods
+        // Get the calling thread's buffer, creating it the first time the thread sends
+        thread_buffer& get_thread_buffer()
+        {
+            let_mutable& slot    = buffers[get_queue_thread_slot() % max_buffer_count];
+            thread_buffer* found = slot.load( std::memory_order_acquire );
+            if ( found != nullptr )
+            {
+                return *found;
+            }
+
+            // Another thread sharing the slot may be creating it at the same time, in which case one of them wins
+            thread_buffer* created = new thread_buffer();
+            if ( slot.compare_exchange_strong( found, created, std::memory_order_acq_rel ) )
+            {
+                return *created;
+            }
+            delete created;
+            return *found;
+        }
+
+        private: // members
+        string name;
+        event<const list<T>&> dispatched_event;
+
+        std::atomic<thread_buffer*> buffers[max_buffer_count];
+
+        // note: dispatch_lock only guards collecting payloads, and keeping an empty batch around for its capacity
+        std::mutex dispatch_lock;
+        list<T> spare_batch;
+    };
+} // namespace rnjin::core
@@ -0,0 +1,124 @@
+/* *** ** *** ** *** ** *** *
+ * Part of rnjin            *
+ * (c) Rajin Shankar, 2019  *
+ *        rajinshankar.com  *
+ * *** ** *** ** *** ** *** */
+
+#include <rnjin.hpp>
+
+#include <random>
+#include <unordered_map>
+
+#include "test/module.h"
+#include "containers.hpp"
+
+using namespace rnjin;
+
+// A hash that sends every key to the same slot, so every key in a table ends up in one run
+struct colliding_hash
+{
+    usize operator()( const int key ) const
+    {
+        return 7;
+    }
+};
+
+// Apply the same random inserts, lookups and erases to a dictionary and a standard map, returning the number of times
+// they disagreed
+template <typename dictionary_type>
+static usize count_mismatches( const int key_range, const usize operation_count )
+{
+    dictionary_type tested;
+    std::unordered_map<int, int> expected;
+    std::mt19937 random( 1234 );
+
+    usize mismatches = 0;
+    for ( usize i = 0; i < operation_count; i++ )
+    {
+        let key = int( random() % key_range );
+        switch ( random() % 3 )
+        {
+            case 0:
+                tested[key]   = int( i );
+                expected[key] = int( i );
+                break;
+            case 1:
+                mismatches += tested.erase( key ) != expected.erase( key ) ? 1 : 0;
+                break;
+            default:
+            {
+                let found = tested.find( key );
+                mismatches += ( found == tested.end() ) != ( expected.count( key ) == 0 ) ? 1 : 0;
+                mismatches += found != tested.end() and found->second != expected[key] ? 1 : 0;
+                break;
+            }
+        }
+        mismatches += tested.size() != expected.size() ? 1 : 0;
+    }
+
+    // Every remaining element is visited once, with its latest value
+    usize visited = 0;
+    foreach ( element : tested )
+    {
+        visited += 1;
+        mismatches += expected.count( element.first ) == 0 or expected[element.first] != element.second ? 1 : 0;
+    }
+    mismatches += visited != expected.size() ? 1 : 0;
+
+    return mismatches;
+}
+
+test( dictionary )
+{
+    note( "Random inserts, lookups and erases" );
+    assert_equal( ( count_mismatches<dictionary<int, int>>( 2000, 200000 ) ), 0 );
+
+    note( "Erasing from a single long run shifts the rest back" );
+    assert_equal( ( count_mismatches<flat_dictionary<int, int, colliding_hash>>( 200, 50000 ) ), 0 );
+
+    note( "String keys" );
+    dictionary<string, int> names;
+    record( names["one"] = 1 );
+    record( names.emplace( "two", 2 ) );
+    record( names.emplace( "one", 10 ) );
+    assert_equal( names.at( "one" ), 1 );
+    record( names.insert_or_assign( "one", 11 ) );
+    assert_equal( names.at( "one" ), 11 );
+    assert_equal( names.count( "three" ), 0 );
+
+    note( "Copies are independent" );
+    dictionary<string, int> copied = names;
+    record( copied.erase( "one" ) );
+    assert_equal( copied.size(), 1 );
+    assert_equal( names.size(), 2 );
+
+    note( "Growing keeps every element" );
+    dictionary<usize, usize> squares;
+    for ( usize i = 0; i < 10000; i++ )
+    {
+        squares[i] = i * i;
+    }
+    usize wrong_squares = 0;
+    for ( usize i = 0; i < 10000; i++ )
+    {
+        wrong_squares += squares.at( i ) != i * i ? 1 : 0;
+    }
+    assert_equal( wrong_squares, 0 );
+    assert_equal( squares.size(), 10000 );
+}
+
+test( set )
+{
+    set<string> names = { "a", "b", "a" };
+    assert_equal( names.size(), 2 );
+    assert_equal( names.insert( "c" ).second, true );
+    assert_equal( names.insert( "c" ).second, false );
+
+    record( names.erase( names.find( "a" ) ) );
+    assert_equal( names.count( "a" ), 0 );
+    assert_equal( names.size(), 2 );
+
+    record( names.clear() );
+    assert_equal( names.empty(), true );
+    assert_equal( names.count( "b" ), 0 );
+}
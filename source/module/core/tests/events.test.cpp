@@ -6,8 +6,12 @@
 
 #include <rnjin.hpp>
 
+#include <atomic>
+#include <thread>
+
 #include "test/module.h"
 #include "event.hpp"
+#include "queued_event.hpp"
 
 using namespace rnjin;
 using namespace rnjin::core;
@@ -45,4 +49,279 @@ test( events )
         test_event.send( "Message 2" );
     }
     test_event.send( "Message 3" );
-}
\ No newline at end of file
+}
+
+// Records the order handlers were called in
+class ordered_class
+{
+    public:
+    ordered_class( string& calls, const char number ) : calls( calls ), number( number ) {}
+
+    void handler( int value )
+    {
+        calls.push_back( number );
+    }
+
+    string& calls;
+    const char number;
+};
+
+test( event_handler_order )
+{
+    using ordered_handler = event_handler<ordered_class, int>;
+
+    event<int> test_event( "Ordered Event" );
+    string calls;
+    ordered_class instances[] = { { calls, '0' }, { calls, '1' }, { calls, '2' }, { calls, '3' }, { calls, '4' }, { calls, '5' } };
+
+    subregion
+    {
+        let handler_0 = ordered_handler( test_event, &instances[0], &ordered_class::handler );
+        let handler_1 = ordered_handler( test_event, &instances[1], &ordered_class::handler );
+        let handler_2 = ordered_handler( test_event, &instances[2], &ordered_class::handler );
+
+        note( "Handlers are called in the order they were added" );
+        record( test_event.send( 0 ) );
+        assert_equal( calls, "012" );
+
+        note( "More handlers than fit inline" );
+        let* handler_3 = new ordered_handler( test_event, &instances[3], &ordered_class::handler );
+        let* handler_4 = new ordered_handler( test_event, &instances[4], &ordered_class::handler );
+        let* handler_5 = new ordered_handler( test_event, &instances[5], &ordered_class::handler );
+        calls.clear();
+        record( test_event.send( 0 ) );
+        assert_equal( calls, "012345" );
+
+        note( "Removing a handler moves the last one into its place" );
+        delete handler_3;
+        calls.clear();
+        record( test_event.send( 0 ) );
+        assert_equal( calls, "01254" );
+
+        delete handler_4;
+        delete handler_5;
+        calls.clear();
+        record( test_event.send( 0 ) );
+        assert_equal( calls, "012" );
+    }
+
+    calls.clear();
+    record( test_event.send( 0 ) );
+    assert_equal( calls, "" );
+    assert_equal( test_event.has_handlers(), false );
+}
+
+// Counts the values it receives from any number of events
+class counting_receiver : public event_receiver
+{
+    public:
+    void on_value( int value )
+    {
+        total += value;
+    }
+
+    int total = 0;
+};
+
+test( event_receiver_lifetime )
+{
+    event<int> outer_event( "Outer Event" );
+
+    note( "Receivers remove their handlers when destroyed" );
+    subregion
+    {
+        counting_receiver receiver;
+        record( receiver.handle_event( outer_event, &counting_receiver::on_value ) );
+        record( receiver.handle_event( outer_event, &counting_receiver::on_value ) );
+        record( outer_event.send( 2 ) );
+        assert_equal( receiver.total, 4 );
+    }
+    assert_equal( outer_event.has_handlers(), false );
+    record( outer_event.send( 1 ) );
+
+    note( "Receivers outliving their events are left alone" );
+    counting_receiver receiver;
+    record( receiver.handle_event( outer_event, &counting_receiver::on_value ) );
+    subregion
+    {
+        event<int> inner_event( "Inner Event" );
+        record( receiver.handle_event( inner_event, &counting_receiver::on_value ) );
+        record( inner_event.send( 10 ) );
+    }
+    record( outer_event.send( 1 ) );
+    assert_equal( receiver.total, 11 );
+}
+
+// Sums the batches a queued event dispatches, optionally queueing (and dispatching) more values while handling them
+class batch_receiver : public event_receiver
+{
+    public:
+    batch_receiver( queued_event<int>& source ) : source( source ) {}
+
+    void on_values( const list<int>& values )
+    {
+        batch_count += 1;
+        foreach ( value : values )
+        {
+            total += value;
+        }
+        if ( requeue )
+        {
+            source.send( 1000 );
+        }
+        if ( redispatch )
+        {
+            redispatch = false;
+            source.send( 1000 );
+            source.dispatch();
+        }
+    }
+
+    queued_event<int>& source;
+    int batch_count = 0;
+    int total       = 0;
+    bool requeue    = false;
+    bool redispatch = false;
+};
+
+test( queued_event )
+{
+    queued_event<int> test_event( "Queued Event" );
+    batch_receiver receiver( test_event );
+    record( receiver.handle_event( test_event.dispatched(), &batch_receiver::on_values ) );
+
+    note( "Sending doesn't call handlers" );
+    record( test_event.send( 1 ) );
+    record( test_event.send( 2 ) );
+    assert_equal( receiver.batch_count, 0 );
+
+    note( "Dispatching hands every queued value to handlers in one batch" );
+    assert_equal( test_event.dispatch(), 2 );
+    assert_equal( receiver.batch_count, 1 );
+    assert_equal( receiver.total, 3 );
+
+    note( "Dispatching with nothing queued doesn't call handlers" );
+    assert_equal( test_event.dispatch(), 0 );
+    assert_equal( receiver.batch_count, 1 );
+
+    note( "Values sent from many threads are each dispatched once" );
+    const int thread_count     = 8;
+    const int sends_per_thread = 10000;
+    list<std::thread> senders;
+    for ( int i = 0; i < thread_count; i++ )
+    {
+        senders.emplace_back( [&]() {
+            for ( int j = 0; j < sends_per_thread; j++ )
+            {
+                test_event.send( 1 );
+            }
+        } );
+    }
+    for ( std::thread& sender : senders )
+    {
+        sender.join();
+    }
+    receiver.total = 0;
+    assert_equal( test_event.dispatch(), thread_count * sends_per_thread );
+    assert_equal( receiver.total, thread_count * sends_per_thread );
+
+    note( "Values sent by handlers arrive with the next dispatch" );
+    receiver.requeue = true;
+    receiver.total   = 0;
+    record( test_event.send( 1 ) );
+    assert_equal( test_event.dispatch(), 1 );
+    assert_equal( receiver.total, 1 );
+    receiver.requeue = false;
+    assert_equal( test_event.dispatch(), 1 );
+    assert_equal( receiver.total, 1001 );
+
+    note( "Handlers can dispatch again, handing over what they sent right away" );
+    receiver.redispatch  = true;
+    receiver.total       = 0;
+    receiver.batch_count = 0;
+    record( test_event.send( 1 ) );
+    assert_equal( test_event.dispatch(), 1 );
+    assert_equal( receiver.batch_count, 2 );
+    assert_equal( receiver.total, 1001 );
+}
+
+// Counts the values it receives from several threads, and any received after its handler was removed
+class concurrent_counter
+{
+    public:
+    void on_value( int value )
+    {
+        total.fetch_add( value );
+        if ( removed.load() )
+        {
+            late_count.fetch_add( 1 );
+        }
+    }
+
+    std::atomic<int> total{ 0 };
+    std::atomic<int> late_count{ 0 };
+    std::atomic<bool> removed{ false };
+};
+
+test( concurrent_event )
+{
+    using counter_handler = event_handler<concurrent_counter, int>;
+
+    concurrent_event<int> test_event( "Concurrent Event" );
+    concurrent_counter permanent;
+    counter_handler permanent_handler( test_event, &permanent, &concurrent_counter::on_value );
+
+    note( "Sending while other threads add and remove handlers" );
+    const int sender_count        = 4;
+    const int subscriber_count    = 4;
+    const int sends_per_thread    = 20000;
+    const int handlers_per_thread = 500;
+
+    std::atomic<int> late_count( 0 );
+    list<std::thread> threads;
+    for ( int i = 0; i < subscriber_count; i++ )
+    {
+        threads.emplace_back( [&]() {
+            for ( int j = 0; j < handlers_per_thread; j++ )
+            {
+                concurrent_counter counter;
+                subregion
+                {
+                    counter_handler handler( test_event, &counter, &concurrent_counter::on_value );
+                    std::this_thread::yield();
+                }
+                counter.removed.store( true );
+                std::this_thread::yield();
+                late_count.fetch_add( counter.late_count.load() );
+            }
+        } );
+    }
+    for ( int i = 0; i < sender_count; i++ )
+    {
+        threads.emplace_back( [&]() {
+            for ( int j = 0; j < sends_per_thread; j++ )
+            {
+                test_event.send( 1 );
+            }
+        } );
+    }
+    for ( std::thread& thread : threads )
+    {
+        thread.join();
+    }
+
+    note( "Every send reached the permanent handler, and no removed handler was called" );
+    assert_equal( permanent.total.load(), sender_count * sends_per_thread );
+    assert_equal( late_count.load(), 0 );
+
+    note( "Handlers added by receivers are removed with them" );
+    subregion
+    {
+        counting_receiver receiver;
+        record( receiver.handle_event( test_event, &counting_receiver::on_value ) );
+        record( test_event.send( 3 ) );
+        assert_equal( receiver.total, 3 );
+    }
+    record( test_event.send( 1 ) );
+    assert_equal( permanent.total.load(), sender_count * sends_per_thread + 4 );
+}
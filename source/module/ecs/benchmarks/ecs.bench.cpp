@@ -0,0 +1,600 @@
+/* *** ** *** ** *** ** *** *
+ * Part of rnjin            *
+ * (c) Rajin Shankar, 2019  *
+ *        rajinshankar.com  *
+ * *** ** *** ** *** ** *** */
+
+#include <rnjin.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+
+#include "benchmark/module.h"
+#include "file/module.h"
+#include "ecs/module.h"
+
+using namespace rnjin;
+using namespace rnjin::ecs;
+using namespace rnjin::benchmark;
+
+/* -------------------------------------------------------------------------- */
+/*                                 Components                                 */
+/* -------------------------------------------------------------------------- */
+
+// Sorted component types with a single value, iterated together by the systems below
+component_class( bench_a )
+{
+    public:
+    bench_a( float value ) : value( value ) {}
+
+    public: // members
+    float value;
+};
+
+component_class( bench_b )
+{
+    public:
+    bench_b( float value ) : value( value ) {}
+
+    public: // members
+    float value;
+};
+
+component_class( bench_c )
+{
+    public:
+    bench_c( float value ) : value( value ) {}
+
+    public: // members
+    float value;
+};
+
+component_class( bench_d )
+{
+    public:
+    bench_d( float value ) : value( value ) {}
+
+    public: // members
+    float value;
+};
+
+// A sparse component type with a single value
+component_class_with_storage( bench_sparse, sparse_set )
+{
+    public:
+    bench_sparse( float value ) : value( value ) {}
+
+    public: // members
+    float value;
+};
+
+// A paged component type with a single value
+component_class_with_storage( bench_paged, paged )
+{
+    public:
+    bench_paged( float value ) : value( value ) {}
+
+    public: // members
+    float value;
+};
+
+// Sparse component types with a single value, packed together by an archetype so systems can update them in chunks
+component_class_with_storage( bench_packed_a, sparse_set )
+{
+    public:
+    bench_packed_a( float value ) : value( value ) {}
+
+    public: // members
+    float value;
+};
+
+component_class_with_storage( bench_packed_b, sparse_set )
+{
+    public:
+    bench_packed_b( float value ) : value( value ) {}
+
+    public: // members
+    float value;
+};
+
+/* -------------------------------------------------------------------------- */
+/*                                   Systems                                  */
+/* -------------------------------------------------------------------------- */
+
+class iterate_1_system : public rnjin::ecs::system<write_to<bench_a>>
+{
+    protected: // inherited
+    void define() override {}
+    void update( entity_components& components ) override
+    {
+        components.writable<bench_a>().value += 1.0f;
+    }
+};
+
+class iterate_2_system : public rnjin::ecs::system<write_to<bench_a>, read_from<bench_b>>
+{
+    protected: // inherited
+    void define() override {}
+    void update( entity_components& components ) override
+    {
+        components.writable<bench_a>().value += components.readable<bench_b>().value;
+    }
+};
+
+class iterate_3_system : public rnjin::ecs::system<write_to<bench_a>, read_from<bench_b>, read_from<bench_c>>
+{
+    protected: // inherited
+    void define() override {}
+    void update( entity_components& components ) override
+    {
+        components.writable<bench_a>().value += components.readable<bench_b>().value * components.readable<bench_c>().value;
+    }
+};
+
+class iterate_4_system : public rnjin::ecs::system<write_to<bench_a>, read_from<bench_b>, read_from<bench_c>, read_from<bench_d>>
+{
+    protected: // inherited
+    void define() override {}
+    void update( entity_components& components ) override
+    {
+        components.writable<bench_a>().value += components.readable<bench_b>().value * components.readable<bench_c>().value + components.readable<bench_d>().value;
+    }
+};
+
+// The same systems, with update called directly rather than virtually
+class iterate_static_1_system : public rnjin::ecs::static_system<iterate_static_1_system, write_to<bench_a>>
+{
+    protected: // inherited
+    void define() override {}
+
+    protected: // update methods
+    void update( entity_components& components )
+    {
+        components.writable<bench_a>().value += 1.0f;
+    }
+};
+
+class iterate_static_2_system : public rnjin::ecs::static_system<iterate_static_2_system, write_to<bench_a>, read_from<bench_b>>
+{
+    protected: // inherited
+    void define() override {}
+
+    protected: // update methods
+    void update( entity_components& components )
+    {
+        components.writable<bench_a>().value += components.readable<bench_b>().value;
+    }
+};
+
+class iterate_static_3_system : public rnjin::ecs::static_system<iterate_static_3_system, write_to<bench_a>, read_from<bench_b>, read_from<bench_c>>
+{
+    protected: // inherited
+    void define() override {}
+
+    protected: // update methods
+    void update( entity_components& components )
+    {
+        components.writable<bench_a>().value += components.readable<bench_b>().value * components.readable<bench_c>().value;
+    }
+};
+
+class iterate_static_4_system : public rnjin::ecs::static_system<iterate_static_4_system, write_to<bench_a>, read_from<bench_b>, read_from<bench_c>, read_from<bench_d>>
+{
+    protected: // inherited
+    void define() override {}
+
+    protected: // update methods
+    void update( entity_components& components )
+    {
+        components.writable<bench_a>().value += components.readable<bench_b>().value * components.readable<bench_c>().value + components.readable<bench_d>().value;
+    }
+};
+
+class iterate_packed_system : public rnjin::ecs::system<write_to<bench_packed_a>, read_from<bench_packed_b>>
+{
+    protected: // inherited
+    void define() override {}
+    void update( entity_components& components ) override
+    {
+        components.writable<bench_packed_a>().value += components.readable<bench_packed_b>().value;
+    }
+};
+
+class iterate_chunked_system : public rnjin::ecs::system<write_to<bench_packed_a>, read_from<bench_packed_b>>
+{
+    protected: // inherited
+    void define() override {}
+    void update( entity_components& components ) override {}
+    void update_chunk( chunk_components& chunk ) override
+    {
+        let targets = chunk.writable<bench_packed_a>();
+        let sources = chunk.readable<bench_packed_b>();
+        for ( usize i = 0; i < chunk.get_count(); i++ )
+        {
+            targets[i].value += sources[i].value;
+        }
+    }
+};
+
+/* -------------------------------------------------------------------------- */
+/*                                   Helpers                                  */
+/* -------------------------------------------------------------------------- */
+
+// Numbers of entities each benchmark is run with
+static const usize entity_counts[] = { 1000, 10000, 100000, 1000000 };
+
+// Adding to or removing from the middle of sorted storage shifts the rest of the list, so random-order cases are only
+// run up to this many entities (anything larger takes minutes)
+static const usize max_shifting_count = 10000;
+
+// How entity ids relate to the order entities are created (and visited) in
+enum class id_pattern
+{
+    // Ids increase in creation order, as in a world where no entity has been destroyed yet
+    sequential,
+    // Ids are shuffled, as in a world that reuses the ids of entities destroyed in arbitrary order
+    random,
+};
+
+static const id_pattern id_patterns[] = { id_pattern::sequential, id_pattern::random };
+
+static string get_case_name( const string& operation, const id_pattern pattern, const usize count )
+{
+    return operation + ( pattern == id_pattern::sequential ? "/sequential/" : "/random/" ) + std::to_string( count );
+}
+
+// Prepare the current world so the next entities created get ids following a given pattern
+// note: destroying entities in random order leaves their ids to be reused in that order
+static void prepare_ids( const id_pattern pattern, const usize count )
+{
+    if ( pattern == id_pattern::sequential )
+    {
+        return;
+    }
+
+    list<std::unique_ptr<entity>> previous( count );
+    for ( usize i = 0; i < count; i++ )
+    {
+        previous[i].reset( new entity() );
+    }
+    std::shuffle( previous.begin(), previous.end(), std::mt19937( 1234 ) );
+    previous.clear();
+}
+
+// Create entities in the current world whose ids follow a given pattern
+static list<std::unique_ptr<entity>> spawn_entities( const id_pattern pattern, const usize count )
+{
+    prepare_ids( pattern, count );
+
+    list<std::unique_ptr<entity>> entities;
+    entities.reserve( count );
+    for ( usize i = 0; i < count; i++ )
+    {
+        entities.emplace_back( new entity() );
+    }
+    return entities;
+}
+
+// Number of system updates to run, so every case visits roughly the same number of entities in total
+static usize get_update_count( const usize count )
+{
+    return std::max<usize>( 1, 10000000 / count );
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                 Benchmarks                                 */
+/* -------------------------------------------------------------------------- */
+
+benchmark( ecs_spawn_despawn )
+{
+    foreach ( count : entity_counts )
+    {
+        foreach ( pattern : id_patterns )
+        {
+            world bench_world;
+            world_scope scope( bench_world );
+
+            prepare_ids( pattern, count );
+
+            list<std::unique_ptr<entity>> entities;
+            entities.reserve( count );
+            measure( get_case_name( "spawn", pattern, count ), count, [&] {
+                for ( usize i = 0; i < count; i++ )
+                {
+                    entities.emplace_back( new entity() );
+                }
+            } );
+
+            foreach ( owner : entities )
+            {
+                owner->add<bench_sparse>( 1.0f );
+            }
+            measure( get_case_name( "despawn", pattern, count ), count, [&] { entities.clear(); } );
+        }
+    }
+}
+
+benchmark( ecs_add_remove )
+{
+    foreach ( count : entity_counts )
+    {
+        foreach ( pattern : id_patterns )
+        {
+            world bench_world;
+            world_scope scope( bench_world );
+
+            let entities = spawn_entities( pattern, count );
+
+            // note: removals go in reverse order, so sequential removals from sorted storage don't shift the list
+            if ( pattern == id_pattern::sequential or count <= max_shifting_count )
+            {
+                measure( get_case_name( "add_sorted", pattern, count ), count, [&] {
+                    foreach ( owner : entities )
+                    {
+                        owner->add<bench_a>( 1.0f );
+                    }
+                } );
+                measure( get_case_name( "remove_sorted", pattern, count ), count, [&] {
+                    for ( usize i = count; i > 0; i-- )
+                    {
+                        entities[i - 1]->remove<bench_a>();
+                    }
+                } );
+            }
+
+            measure( get_case_name( "add_sparse", pattern, count ), count, [&] {
+                foreach ( owner : entities )
+                {
+                    owner->add<bench_sparse>( 1.0f );
+                }
+            } );
+            measure( get_case_name( "remove_sparse", pattern, count ), count, [&] {
+                for ( usize i = count; i > 0; i-- )
+                {
+                    entities[i - 1]->remove<bench_sparse>();
+                }
+            } );
+
+            measure( get_case_name( "add_paged", pattern, count ), count, [&] {
+                foreach ( owner : entities )
+                {
+                    owner->add<bench_paged>( 1.0f );
+                }
+            } );
+            measure( get_case_name( "remove_paged", pattern, count ), count, [&] {
+                for ( usize i = count; i > 0; i-- )
+                {
+                    entities[i - 1]->remove<bench_paged>();
+                }
+            } );
+
+            // Adding to every entity at once merges the additions into the list in one pass
+            prepare_ids( pattern, count );
+            entity_batch batch( count );
+            measure( get_case_name( "batch_add_sorted", pattern, count ), count, [&] { batch.add<bench_a>( 1.0f ); } );
+            measure( get_case_name( "batch_remove_sorted", pattern, count ), count, [&] { batch.remove<bench_a>(); } );
+        }
+    }
+}
+
+benchmark( ecs_lookups )
+{
+    foreach ( count : entity_counts )
+    {
+        foreach ( pattern : id_patterns )
+        {
+            world bench_world;
+            world_scope scope( bench_world );
+
+            let entities = spawn_entities( pattern, count );
+            foreach ( owner : entities )
+            {
+                owner->add<bench_a>( 1.0f );
+                owner->add<bench_sparse>( 1.0f );
+                owner->add<bench_paged>( 1.0f );
+            }
+
+            float sum = 0.0f;
+            measure( get_case_name( "owned_by_sorted", pattern, count ), count, [&] {
+                foreach ( owner : entities )
+                {
+                    sum += owner->get<bench_a>()->value;
+                }
+            } );
+            measure( get_case_name( "owned_by_sparse", pattern, count ), count, [&] {
+                foreach ( owner : entities )
+                {
+                    sum += owner->get<bench_sparse>()->value;
+                }
+            } );
+            measure( get_case_name( "owned_by_paged", pattern, count ), count, [&] {
+                foreach ( owner : entities )
+                {
+                    sum += owner->get<bench_paged>()->value;
+                }
+            } );
+
+            list<bench_a::reference> references;
+            references.reserve( count );
+            foreach ( owner : entities )
+            {
+                references.emplace_back( owner.get() );
+            }
+            measure( get_case_name( "resolve_reference", pattern, count ), count, [&] {
+                foreach ( target : references )
+                {
+                    sum += target.get_pointer()->value;
+                }
+            } );
+
+            keep( sum );
+        }
+    }
+}
+
+benchmark( ecs_iteration )
+{
+    foreach ( count : entity_counts )
+    {
+        foreach ( pattern : id_patterns )
+        {
+            world bench_world;
+            world_scope scope( bench_world );
+
+            let entities = spawn_entities( pattern, count );
+            foreach ( owner : entities )
+            {
+                owner->add<bench_a>( 1.0f );
+                owner->add<bench_b>( 1.0f );
+                owner->add<bench_c>( 1.0f );
+                owner->add<bench_d>( 1.0f );
+            }
+
+            let update_count = get_update_count( count );
+            iterate_1_system iterate_1;
+            iterate_2_system iterate_2;
+            iterate_3_system iterate_3;
+            iterate_4_system iterate_4;
+
+            measure( get_case_name( "iterate_1", pattern, count ), count * update_count, [&] {
+                for ( usize i = 0; i < update_count; i++ )
+                {
+                    iterate_1.update_all();
+                }
+            } );
+            measure( get_case_name( "iterate_2", pattern, count ), count * update_count, [&] {
+                for ( usize i = 0; i < update_count; i++ )
+                {
+                    iterate_2.update_all();
+                }
+            } );
+            measure( get_case_name( "iterate_3", pattern, count ), count * update_count, [&] {
+                for ( usize i = 0; i < update_count; i++ )
+                {
+                    iterate_3.update_all();
+                }
+            } );
+            measure( get_case_name( "iterate_4", pattern, count ), count * update_count, [&] {
+                for ( usize i = 0; i < update_count; i++ )
+                {
+                    iterate_4.update_all();
+                }
+            } );
+
+            // Static dispatch lets update be inlined into the loop over entities
+            iterate_static_1_system iterate_static_1;
+            iterate_static_2_system iterate_static_2;
+            iterate_static_3_system iterate_static_3;
+            iterate_static_4_system iterate_static_4;
+
+            measure( get_case_name( "iterate_static_1", pattern, count ), count * update_count, [&] {
+                for ( usize i = 0; i < update_count; i++ )
+                {
+                    iterate_static_1.update_all();
+                }
+            } );
+            measure( get_case_name( "iterate_static_2", pattern, count ), count * update_count, [&] {
+                for ( usize i = 0; i < update_count; i++ )
+                {
+                    iterate_static_2.update_all();
+                }
+            } );
+            measure( get_case_name( "iterate_static_3", pattern, count ), count * update_count, [&] {
+                for ( usize i = 0; i < update_count; i++ )
+                {
+                    iterate_static_3.update_all();
+                }
+            } );
+            measure( get_case_name( "iterate_static_4", pattern, count ), count * update_count, [&] {
+                for ( usize i = 0; i < update_count; i++ )
+                {
+                    iterate_static_4.update_all();
+                }
+            } );
+        }
+    }
+}
+
+// Compare updating an archetype's packed range one entity at a time with updating it in chunks
+benchmark( ecs_chunked_iteration )
+{
+    foreach ( count : entity_counts )
+    {
+        world bench_world;
+        world_scope scope( bench_world );
+
+        archetype<bench_packed_a, bench_packed_b> packed;
+        entity_batch batch( count );
+        batch.add<bench_packed_a>( 1.0f );
+        batch.add<bench_packed_b>( 1.0f );
+
+        let update_count = get_update_count( count );
+        iterate_packed_system iterate_packed;
+        iterate_chunked_system iterate_chunked;
+
+        measure( "iterate_packed/" + std::to_string( count ), count * update_count, [&] {
+            for ( usize i = 0; i < update_count; i++ )
+            {
+                iterate_packed.update_all();
+            }
+        } );
+        measure( "iterate_chunked/" + std::to_string( count ), count * update_count, [&] {
+            for ( usize i = 0; i < update_count; i++ )
+            {
+                iterate_chunked.update_all();
+            }
+        } );
+    }
+}
+
+// Time writing every component of two types to a snapshot file, and restoring them from it
+benchmark( ecs_snapshots )
+{
+    using bench_snapshot = snapshot<bench_a, bench_sparse>;
+
+    foreach ( count : entity_counts )
+    {
+        world bench_world;
+        world_scope scope( bench_world );
+
+        entity_batch batch( count );
+        batch.add<bench_a>( 1.0f );
+        batch.add<bench_sparse>( 1.0f );
+
+        measure( "snapshot_write/" + std::to_string( count ), count, [&] {
+            io::file checkpoint( "ecs_snapshot", io::file::mode::write );
+            bench_snapshot::write( checkpoint );
+        } );
+        measure( "snapshot_read/" + std::to_string( count ), count, [&] {
+            io::file checkpoint( "ecs_snapshot", io::file::mode::read );
+            bench_snapshot::read( checkpoint );
+        } );
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/*                               Reflection Info                              */
+/* -------------------------------------------------------------------------- */
+
+namespace reflection
+{
+    auto_reflect_component(, bench_a );
+    auto_reflect_component(, bench_b );
+    auto_reflect_component(, bench_c );
+    auto_reflect_component(, bench_d );
+    auto_reflect_component(, bench_sparse );
+    auto_reflect_component(, bench_paged );
+    auto_reflect_component(, bench_packed_a );
+    auto_reflect_component(, bench_packed_b );
+    auto_reflect_type(, iterate_1_system );
+    auto_reflect_type(, iterate_2_system );
+    auto_reflect_type(, iterate_3_system );
+    auto_reflect_type(, iterate_4_system );
+    auto_reflect_type(, iterate_static_1_system );
+    auto_reflect_type(, iterate_static_2_system );
+    auto_reflect_type(, iterate_static_3_system );
+    auto_reflect_type(, iterate_static_4_system );
+    auto_reflect_type(, iterate_packed_system );
+    auto_reflect_type(, iterate_chunked_system );
+} // namespace reflection
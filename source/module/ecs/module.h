@@ -6,6 +6,14 @@
 
 #pragma once
 
+#include "public/signature.hpp"
 #include "public/entity.hpp"
+#include "public/world.hpp"
 #include "public/component.hpp"
-#include "public/system.hpp"
\ No newline at end of file
+#include "public/entity_batch.hpp"
+#include "public/archetype.hpp"
+#include "public/command_buffer.hpp"
+#include "public/snapshot.hpp"
+#include "public/system.hpp"
+#include "public/observer.hpp"
+#include "public/scheduler.hpp"
\ No newline at end of file
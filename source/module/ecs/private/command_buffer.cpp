@@ -0,0 +1,70 @@
+/* *** ** *** ** *** ** *** *
+ * Part of rnjin            *
+ * (c) Rajin Shankar, 2019  *
+ *        rajinshankar.com  *
+ * *** ** *** ** *** ** *** */
+
+#include "command_buffer.hpp"
+
+namespace rnjin::ecs
+{
+    command_buffer::command_buffer() : command_buffer( world::get_current() ) {}
+    command_buffer::command_buffer( world& target_world ) : pass_member( target_world ) {}
+    command_buffer::~command_buffer()
+    {
+        check_error_condition( pass, ecs_log_errors, not is_empty(), "Command buffer destroyed with unapplied changes (\1 entities to destroy)", destroyed_entities.size() );
+    }
+
+    void command_buffer::destroy( entity* target )
+    {
+        check_error_condition( return, ecs_log_errors, target == nullptr, "Can't destroy a null entity" );
+        check_error_condition( return, ecs_log_errors, &target->get_world() != &target_world, "Can't record destroying an entity of another world (\1)", target->get_id() );
+
+        let is_already_destroyed = std::find( destroyed_entities.begin(), destroyed_entities.end(), target ) != destroyed_entities.end();
+        check_error_condition( return, ecs_log_errors, is_already_destroyed, "Entity (\1) is already being destroyed", target->get_id() );
+
+        discard( *target );
+        destroyed_entities.push_back( target );
+    }
+
+    bool command_buffer::discard( const entity& target )
+    {
+        bool discarded_any = false;
+        for ( auto& entry : changes_by_type )
+        {
+            discarded_any = entry.second->discard( target ) or discarded_any;
+        }
+
+        return discarded_any;
+    }
+
+    void command_buffer::apply()
+    {
+        // note: indexed, since event handlers can record changes to new component types while these are applied
+        for ( usize i = 0; i < changes_by_type.size(); i++ )
+        {
+            changes_by_type[i].second->apply( target_world );
+        }
+
+        // note: destroying an entity removes its components immediately
+        list<entity*> destroyed_targets = std::move( destroyed_entities );
+        destroyed_entities.clear();
+        foreach ( target : destroyed_targets )
+        {
+            delete target;
+        }
+    }
+
+    bool command_buffer::is_empty() const
+    {
+        foreach ( entry : changes_by_type )
+        {
+            if ( not entry.second->is_empty() )
+            {
+                return false;
+            }
+        }
+
+        return destroyed_entities.empty();
+    }
+} // namespace rnjin::ecs
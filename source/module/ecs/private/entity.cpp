@@ -7,6 +7,7 @@
 #include "entity.hpp"
 
 #include "component.hpp"
+#include "world.hpp"
 
 namespace rnjin::ecs
 {
@@ -28,27 +29,55 @@ namespace rnjin::ecs
     log::source::masked ecs_log_verbose = get_ecs_log().mask( log_flag::verbose );
     log::source::masked ecs_log_errors  = get_ecs_log().mask( log_flag::errors );
 
-    entity::entity()                //
-      : destroying( false ) //
+    std::ostream& operator<<( std::ostream& stream, const entity_id& id )
+    {
+        stream << "id=" << id.value() << "." << id.get_generation();
+        return stream;
+    }
+
+    entity::entity() : entity( world::get_current() ) {}
+    entity::entity( world& owner_world )                       //
+      : owner_world( &owner_world ),                           //
+        entity_id( owner_world.allocate_entity_id( *this ) ),  //
+        destroying( false )                                    //
     {}
     entity::~entity()
     {
         destroying = true;
-        
-        ecs_log_verbose.print( "Destroy entity (\1), (\2 owned component types)", get_id(), owned_component_types.size() );
-        foreach ( component_type_handle_pointer : owned_component_types )
-        {
-            component_type_handle_pointer->on_entity_destroyed( *this );
-        }
+
+        // Notify each owned component type, working from a copy since handlers can remove other components
+        let owned_types = get_signature();
+        ecs_log_verbose.print( "Destroy entity (\1), (\2 owned component types)", get_id(), owned_types.count() );
+        owned_types.for_each( [this]( const component_type_index type_index ) {
+            get_component_type_handle( type_index )->on_entity_destroyed( *this );
+        } );
+
+        // Only reuse the index once nothing refers to the entity's components anymore
+        owner_world->release_entity_id( get_id() );
     }
 
     void entity::add_component_type_handle( const component_type_handle_base* type_handle_pointer )
     {
-        owned_component_types.insert( type_handle_pointer );
+        owner_world->get_mutable_signature( get_id() ).set( type_handle_pointer->get_type_index() );
     }
     void entity::remove_component_type_handle( const component_type_handle_base* type_handle_pointer )
     {
-        owned_component_types.erase( type_handle_pointer );
+        owner_world->get_mutable_signature( get_id() ).reset( type_handle_pointer->get_type_index() );
+    }
+
+    const signature& entity::get_signature() const
+    {
+        return owner_world->get_signature( get_id() );
+    }
+
+    const signature& entity::get_signature( const id entity_id )
+    {
+        return world::get_current().get_signature( entity_id );
+    }
+
+    bool entity::is_alive( const id entity_id )
+    {
+        return world::get_current().is_alive( entity_id );
     }
 
     // define_static_group( entity::events );
@@ -0,0 +1,71 @@
+/* *** ** *** ** *** ** *** *
+ * Part of rnjin            *
+ * (c) Rajin Shankar, 2019  *
+ *        rajinshankar.com  *
+ * *** ** *** ** *** ** *** */
+
+#include "entity_batch.hpp"
+
+#include <algorithm>
+
+namespace rnjin::ecs
+{
+    entity_batch::entity_batch( const usize count ) : entity_batch( count, world::get_current() ) {}
+    entity_batch::entity_batch( const usize count, world& owner_world ) : pass_member( owner_world )
+    {
+        // note: entities are default constructed, so they're created with owner_world as the current world
+        {
+            world_scope scope( owner_world );
+            entities.reset( new entity[count] );
+        }
+
+        entity_pointers.reserve( count );
+        for ( usize i = 0; i < count; i++ )
+        {
+            entity_pointers.push_back( &entities[i] );
+        }
+
+        ecs_log_verbose.print( "Create batch of \1 entities", count );
+    }
+    entity_batch::~entity_batch()
+    {
+        ecs_log_verbose.print( "Destroy batch of \1 entities (\2 component types)", entity_pointers.size(), component_types.size() );
+
+        foreach ( target : entity_pointers )
+        {
+            target->destroying = true;
+        }
+
+        // Remove component types added through the batch all at once, so entities only remove the ones added individually
+        foreach ( type_handle_pointer : component_types )
+        {
+            type_handle_pointer->on_entities_destroyed( owner_world, entity_pointers );
+            foreach ( target : entity_pointers )
+            {
+                target->remove_component_type_handle( type_handle_pointer );
+            }
+        }
+    }
+
+    void entity_batch::add_component_type_handle( const component_type_handle_base* type_handle_pointer )
+    {
+        foreach ( target : entity_pointers )
+        {
+            target->add_component_type_handle( type_handle_pointer );
+        }
+
+        if ( std::find( component_types.begin(), component_types.end(), type_handle_pointer ) == component_types.end() )
+        {
+            component_types.push_back( type_handle_pointer );
+        }
+    }
+    void entity_batch::remove_component_type_handle( const component_type_handle_base* type_handle_pointer )
+    {
+        foreach ( target : entity_pointers )
+        {
+            target->remove_component_type_handle( type_handle_pointer );
+        }
+
+        component_types.erase( std::remove( component_types.begin(), component_types.end(), type_handle_pointer ), component_types.end() );
+    }
+} // namespace rnjin::ecs
@@ -0,0 +1,292 @@
+/* *** ** *** ** *** ** *** *
+ * Part of rnjin            *
+ * (c) Rajin Shankar, 2019  *
+ *        rajinshankar.com  *
+ * *** ** *** ** *** ** *** */
+
+#include "scheduler.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+namespace rnjin::ecs
+{
+    // Current time in seconds, for measuring system update times
+    static double get_time()
+    {
+        using clock = std::chrono::steady_clock;
+        return std::chrono::duration<double>( clock::now().time_since_epoch() ).count();
+    }
+
+    scheduler::scheduler( worker::pool& workers )
+      : pass_member( workers ),     //
+        graph_is_built( false ),    //
+        finished_count( 0 ),        //
+        frame_time( 0.0 ),          //
+        critical_path_time( 0.0 )   //
+    {}
+    scheduler::~scheduler() {}
+
+    void scheduler::add_system( system_base& new_system, const type_key system_type )
+    {
+        foreach ( existing : nodes )
+        {
+            check_error_condition( return, ecs_log_errors, existing.system == &new_system, "System (\1) has already been added to this scheduler", &new_system );
+        }
+
+        // note: dependencies are cleared first, since a system may be defined by more than one scheduler
+        new_system.dependencies.clear();
+        new_system.define();
+
+        nodes.push_back( node{ &new_system, system_type, {}, 0, 0, 0.0 } );
+        graph_is_built = false;
+    }
+
+    void scheduler::remove( system_base& old_system )
+    {
+        let old_node = std::find_if( nodes.begin(), nodes.end(), [&]( const node& n ) { return n.system == &old_system; } );
+        check_error_condition( return, ecs_log_errors, old_node == nodes.end(), "System (\1) isn't part of this scheduler", &old_system );
+
+        nodes.erase( old_node );
+        graph_is_built = false;
+    }
+
+    // Find an update order and the edges between systems that can't update at the same time
+    // note: explicit dependencies decide the order first (ties broken by the order systems were added), then
+    //       conflicting systems are ordered the same way, so the resulting graph never has cycles
+    void scheduler::build_graph()
+    {
+        let count = nodes.size();
+        for ( node& each_node : nodes )
+        {
+            each_node.dependents.clear();
+            each_node.dependency_count = 0;
+        }
+
+        // Explicit dependencies
+        for ( usize to = 0; to < count; to++ )
+        {
+            foreach ( dependency : nodes[to].system->get_dependencies() )
+            {
+                for ( usize from = 0; from < count; from++ )
+                {
+                    if ( from != to and nodes[from].system_type == dependency )
+                    {
+                        add_edge( from, to );
+                    }
+                }
+            }
+        }
+
+        // Order systems so each comes after its dependencies, picking the earliest-added system when there's a choice
+        update_order.clear();
+        list<usize> remaining_counts( count );
+        list<bool> is_ordered( count, false );
+        for ( usize i = 0; i < count; i++ )
+        {
+            remaining_counts[i] = nodes[i].dependency_count;
+        }
+        while ( update_order.size() < count )
+        {
+            usize next = count;
+            for ( usize i = 0; i < count; i++ )
+            {
+                if ( not is_ordered[i] and remaining_counts[i] == 0 )
+                {
+                    next = i;
+                    break;
+                }
+            }
+            if ( next == count )
+            {
+                break;
+            }
+
+            is_ordered[next] = true;
+            update_order.push_back( next );
+            foreach ( dependent : nodes[next].dependents )
+            {
+                remaining_counts[dependent] -= 1;
+            }
+        }
+
+        // If dependencies are circular, fall back to the order systems were added in, ignoring dependencies on later systems
+        if ( update_order.size() < count )
+        {
+            ecs_log_errors.print_error( "Systems have circular dependencies, so \1 systems will update in the order they were added", count );
+
+            update_order.clear();
+            for ( usize i = 0; i < count; i++ )
+            {
+                update_order.push_back( i );
+                nodes[i].dependents.erase(
+                    std::remove_if( nodes[i].dependents.begin(), nodes[i].dependents.end(), [&]( const usize dependent ) { return dependent < i; } ),
+                    nodes[i].dependents.end() );
+            }
+            for ( node& each_node : nodes )
+            {
+                each_node.dependency_count = 0;
+            }
+            foreach ( each_node : nodes )
+            {
+                foreach ( dependent : each_node.dependents )
+                {
+                    nodes[dependent].dependency_count += 1;
+                }
+            }
+        }
+
+        // Conflicting systems update in the order found above
+        for ( usize first = 0; first < count; first++ )
+        {
+            for ( usize second = first + 1; second < count; second++ )
+            {
+                if ( conflicts( update_order[first], update_order[second] ) )
+                {
+                    add_edge( update_order[first], update_order[second] );
+                }
+            }
+        }
+
+        graph_is_built = true;
+        ecs_log_verbose.print( "Build update graph for \1 systems", count );
+    }
+
+    void scheduler::add_edge( const usize from, const usize to )
+    {
+        let_mutable& dependents = nodes[from].dependents;
+        if ( std::find( dependents.begin(), dependents.end(), to ) != dependents.end() )
+        {
+            return;
+        }
+
+        dependents.push_back( to );
+        nodes[to].dependency_count += 1;
+    }
+
+    // Two systems conflict if either one writes a component type the other one accesses
+    bool scheduler::conflicts( const usize first, const usize second ) const
+    {
+        let& first_system  = *nodes[first].system;
+        let& second_system = *nodes[second].system;
+
+        let accesses = []( const system_base& target, const type_key component_type ) {
+            let& read    = target.get_read_types();
+            let& written = target.get_written_types();
+            return std::find( read.begin(), read.end(), component_type ) != read.end() or
+                   std::find( written.begin(), written.end(), component_type ) != written.end();
+        };
+
+        foreach ( component_type : first_system.get_written_types() )
+        {
+            if ( accesses( second_system, component_type ) )
+            {
+                return true;
+            }
+        }
+        foreach ( component_type : second_system.get_written_types() )
+        {
+            if ( accesses( first_system, component_type ) )
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void scheduler::update_all()
+    {
+        if ( not graph_is_built )
+        {
+            build_graph();
+        }
+        if ( nodes.empty() )
+        {
+            frame_time         = 0.0;
+            critical_path_time = 0.0;
+            return;
+        }
+
+        let frame_start_time = get_time();
+
+        subregion
+        {
+            std::lock_guard<std::mutex> lock( frame_lock );
+            ready_nodes.clear();
+            finished_count = 0;
+            foreach ( index : update_order )
+            {
+                nodes[index].remaining_dependency_count = nodes[index].dependency_count;
+                if ( nodes[index].dependency_count == 0 )
+                {
+                    ready_nodes.push_back( index );
+                }
+            }
+        }
+
+        // Every thread runs ready systems until all systems have updated
+        let runner_count = std::min( workers.get_worker_thread_count() + 1, nodes.size() );
+        workers.run_all( runner_count, [this]( const usize runner ) { run_ready_systems(); } );
+
+        frame_time = get_time() - frame_start_time;
+        update_critical_path_time();
+    }
+
+    // Take systems whose dependencies have all updated, until every system has updated
+    // note: systems are taken in the order they became ready, so with a single thread they update in update_order
+    void scheduler::run_ready_systems()
+    {
+        std::unique_lock<std::mutex> lock( frame_lock );
+        while ( true )
+        {
+            systems_ready.wait( lock, [this]() { return not ready_nodes.empty() or finished_count == nodes.size(); } );
+            if ( finished_count == nodes.size() )
+            {
+                return;
+            }
+
+            let index = ready_nodes.front();
+            ready_nodes.erase( ready_nodes.begin() );
+            lock.unlock();
+
+            let start_time = get_time();
+            nodes[index].system->update_all();
+            let update_time = get_time() - start_time;
+
+            lock.lock();
+            nodes[index].update_time = update_time;
+            finished_count += 1;
+            foreach ( dependent : nodes[index].dependents )
+            {
+                nodes[dependent].remaining_dependency_count -= 1;
+                if ( nodes[dependent].remaining_dependency_count == 0 )
+                {
+                    ready_nodes.push_back( dependent );
+                }
+            }
+            systems_ready.notify_all();
+        }
+    }
+
+    // Find the longest chain of dependent systems, using the update times from the last frame
+    void scheduler::update_critical_path_time()
+    {
+        list<double> path_start_times( nodes.size(), 0.0 );
+        critical_path_time = 0.0;
+
+        // note: update_order is already sorted so each system comes after the ones it depends on
+        foreach ( index : update_order )
+        {
+            let path_end_time  = path_start_times[index] + nodes[index].update_time;
+            critical_path_time = std::max( critical_path_time, path_end_time );
+
+            foreach ( dependent : nodes[index].dependents )
+            {
+                path_start_times[dependent] = std::max( path_start_times[dependent], path_end_time );
+            }
+        }
+
+        ecs_log_verbose.print( "Update \1 systems in \2s (critical path \3s)", nodes.size(), frame_time, critical_path_time );
+    }
+} // namespace rnjin::ecs
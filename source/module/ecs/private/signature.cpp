@@ -0,0 +1,49 @@
+/* *** ** *** ** *** ** *** *
+ * Part of rnjin            *
+ * (c) Rajin Shankar, 2019  *
+ *        rajinshankar.com  *
+ * *** ** *** ** *** ** *** */
+
+#include "signature.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+
+#include "entity.hpp"
+
+namespace rnjin::ecs
+{
+    // Handles of all registered component types, indexed by component type index
+    // note: constant-initialized, so it's ready before component types are registered during static initialization
+    // note: registration only ever fills the next empty slot, so handles are read without taking the registration lock
+    //       (entities look them up on every destroy, in every world)
+    static std::array<std::atomic<const component_type_handle_base*>, max_component_types> component_type_handles{};
+    static usize registered_type_count = 0;
+
+    // note: component types are shared by all worlds, so types first used on different threads can be registered at once
+    static std::mutex& get_registration_lock()
+    {
+        static std::mutex registration_lock;
+        return registration_lock;
+    }
+
+    component_type_index register_component_type( const component_type_handle_base* type_handle_pointer, const string& type_name )
+    {
+        std::lock_guard<std::mutex> lock( get_registration_lock() );
+
+        // note: there's no index to fall back on, since two types sharing one would have worlds treat one type's storage as the other's
+        check_error_condition( std::abort(), ecs_log_errors, registered_type_count >= max_component_types, "Too many component types, can't register '\1' (at most \2 are supported)", type_name, max_component_types );
+
+        let index = registered_type_count;
+        component_type_handles[index].store( type_handle_pointer, std::memory_order_release );
+        registered_type_count += 1;
+        return index;
+    }
+
+    const component_type_handle_base* get_component_type_handle( const component_type_index index )
+    {
+        return component_type_handles[index].load( std::memory_order_acquire );
+    }
+} // namespace rnjin::ecs
@@ -0,0 +1,95 @@
+/* *** ** *** ** *** ** *** *
+ * Part of rnjin            *
+ * (c) Rajin Shankar, 2019  *
+ *        rajinshankar.com  *
+ * *** ** *** ** *** ** *** */
+
+#include "world.hpp"
+
+namespace rnjin::ecs
+{
+    // The world entered by the calling thread (see world_scope), or nullptr for the default world
+    static thread_local world* current_world = nullptr;
+
+    world::world()                  //
+      : current_change_tick( 1 ),   //
+        generations( 1, 0 ),        //
+        signatures( 1 ),            //
+        entities( 1, nullptr )      //
+    {}
+    world::~world() {}
+
+    change_tick world::get_change_tick() const
+    {
+        return current_change_tick.load( std::memory_order_relaxed );
+    }
+    change_tick world::advance_change_tick()
+    {
+        return current_change_tick.fetch_add( 1, std::memory_order_relaxed );
+    }
+
+    entity_id world::allocate_entity_id( entity& new_entity )
+    {
+        if ( not free_indices.empty() )
+        {
+            let index = free_indices.back();
+            free_indices.pop_back();
+            entities[index] = &new_entity;
+            return entity_id( index, generations[index] );
+        }
+
+        generations.push_back( 0 );
+        signatures.emplace_back();
+        entities.push_back( &new_entity );
+        return entity_id( static_cast<entity_id::value_type>( generations.size() - 1 ), 0 );
+    }
+    void world::release_entity_id( const entity_id id )
+    {
+        generations[id.value()] += 1;
+        signatures[id.value()].clear();
+        entities[id.value()] = nullptr;
+        free_indices.push_back( id.value() );
+    }
+
+    entity* world::get_entity( const entity_id id ) const
+    {
+        return is_alive( id ) ? entities[id.value()] : nullptr;
+    }
+
+    const signature& world::get_signature( const entity_id id ) const
+    {
+        static const signature empty_signature;
+
+        let key = id.value();
+        return key < signatures.size() ? signatures[key] : empty_signature;
+    }
+    signature& world::get_mutable_signature( const entity_id id )
+    {
+        return signatures[id.value()];
+    }
+
+    bool world::is_alive( const entity_id id ) const
+    {
+        return id.is_valid() and id.value() < generations.size() and generations[id.value()] == id.get_generation();
+    }
+
+    // note: a function-local static, so it's created before (and destroyed after) any static entities
+    world& world::get_default()
+    {
+        static world default_world;
+        return default_world;
+    }
+    world& world::get_current()
+    {
+        return current_world != nullptr ? *current_world : get_default();
+    }
+
+    world_scope::world_scope( world& target ) : previous( current_world )
+    {
+        current_world = &target;
+    }
+    world_scope::~world_scope()
+    {
+        current_world = previous;
+    }
+} // namespace rnjin::ecs
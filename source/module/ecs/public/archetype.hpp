@@ -0,0 +1,160 @@
+/* *** ** *** ** *** ** *** *
+ * Part of rnjin            *
+ * (c) Rajin Shankar, 2019  *
+ *        rajinshankar.com  *
+ * *** ** *** ** *** ** *** */
+
+#pragma once
+#include <rnjin.hpp>
+
+#include <tuple>
+
+#include "entity.hpp"
+#include "component.hpp"
+#include "world.hpp"
+
+#include "core/module.h"
+#include "reflection/module.h"
+
+namespace rnjin::ecs
+{
+    // A set of component types whose components are kept packed together. Entities that own all of the component
+    // types have their components moved to the front of each type's list, in the same order, so the front of each list
+    // acts as one column of a structure-of-arrays. Systems defined on exactly these component types walk the packed
+    // range directly (in chunks of archetype_base::chunk_size), visiting only matching entities and never comparing owner IDs
+    // ex. `archetype<position, velocity> moving;` packs every entity that owns both a position and a velocity
+    // note: component types must use storage_mode::sparse_set, and can only be owned by one archetype at a time in each world
+    // note: total added complexity is O( component_type_count ) swaps for each add / remove of an owned component type
+    template <typename... component_types>
+    class archetype : public archetype_base
+    {
+        static_assert( sizeof...( component_types ) > 1, "Archetypes need at least two component types" );
+        static_assert( ( ( component_types::storage == storage_mode::sparse_set ) and ... ), "Archetype component types must use storage_mode::sparse_set" );
+
+        private: // types
+        using first_component_type = std::tuple_element_t<0, std::tuple<component_types...>>;
+
+        public: // methods
+        // Take ownership of each component type in the world that's current on this thread
+        archetype() : archetype( world::get_current() ) {}
+
+        // Take ownership of each component type in a given world, and pack any entities that already own all of them
+        // note: if any component type is already owned by another archetype, none are claimed and nothing is packed
+        archetype( world& owner_world ) : archetype_base( sizeof...( component_types ) ), pass_member( owner_world )
+        {
+            let claimed_all = ( claim<component_types>() and ... );
+            if ( not claimed_all )
+            {
+                // Give back the types claimed before the failure, so this archetype never reorders any lists
+                ( release<component_types>(), ... );
+                return;
+            }
+            pack_all();
+
+            ecs_log_verbose.print( "Create archetype of \1 component types (\2 entities packed)", component_type_count, count );
+        }
+
+        // Release ownership of each component type
+        // note: components are left in their current positions
+        ~archetype()
+        {
+            ( release<component_types>(), ... );
+        }
+
+        // Check if an entity's components are currently in the packed range
+        bool is_packed( const entity::id owner_id ) const
+        {
+            return first_component_type::sparse_index_of( first_component_type::get_state( owner_world ), owner_id ) < count;
+        }
+
+        public: // accessors
+        let_mutable& get_world get_value( owner_world );
+
+        private: // methods
+        // Move an entity's components into the packed range if it now owns all component types
+        void on_component_added( const entity::id owner_id ) override
+        {
+            if ( not owns_all( owner_id ) or is_packed( owner_id ) )
+            {
+                return;
+            }
+
+            // The first slot after the packed range becomes part of it
+            ( swap_into<component_types>( owner_id, count ), ... );
+            count += 1;
+        }
+
+        // Move an entity's components out of the packed range, since it will no longer own all component types
+        void on_component_removing( const entity::id owner_id ) override
+        {
+            if ( not owns_all( owner_id ) or not is_packed( owner_id ) )
+            {
+                return;
+            }
+
+            // The last slot of the packed range is no longer part of it
+            count -= 1;
+            ( swap_into<component_types>( owner_id, count ), ... );
+        }
+
+        // Pack the components of every entity that owns all component types again, from scratch
+        void on_components_restored() override
+        {
+            count = 0;
+            pack_all();
+        }
+
+        // Pack the components of every entity that owns all component types and isn't packed yet
+        void pack_all()
+        {
+            // note: owner IDs are copied first, since packing reorders the list being read
+            let& first_components = first_component_type::get_state( owner_world ).components;
+            list<entity::id> owner_ids;
+            owner_ids.reserve( first_components.size() );
+            foreach ( owned : first_components )
+            {
+                owner_ids.push_back( owned.get_owner_id() );
+            }
+            foreach ( owner_id : owner_ids )
+            {
+                on_component_added( owner_id );
+            }
+        }
+
+        bool owns_all( const entity::id owner_id ) const
+        {
+            return ( ( component_types::sparse_index_of( component_types::get_state( owner_world ), owner_id ) != component_types::invalid_index ) and ... );
+        }
+
+        // Move an entity's component of type T to a given index of its list
+        template <typename T>
+        void swap_into( const entity::id owner_id, const usize index )
+        {
+            let_mutable& state = T::get_state( owner_world );
+            T::swap_components( state, T::sparse_index_of( state, owner_id ), index );
+        }
+
+        // Take ownership of component type T, or return false if another archetype already owns it
+        template <typename T>
+        bool claim()
+        {
+            let_mutable& state = T::get_state( owner_world );
+            check_error_condition( return false, ecs_log_errors, state.owning_archetype != nullptr, "Component type '\1' is already owned by another archetype", reflection::get_type_name<T>() );
+            state.owning_archetype = this;
+            return true;
+        }
+
+        template <typename T>
+        void release()
+        {
+            let_mutable& state = T::get_state( owner_world );
+            if ( state.owning_archetype == this )
+            {
+                state.owning_archetype = nullptr;
+            }
+        }
+
+        private: // members
+        world& owner_world;
+    };
+} // namespace rnjin::ecs
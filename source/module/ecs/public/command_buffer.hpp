@@ -0,0 +1,199 @@
+/* *** ** *** ** *** ** *** *
+ * Part of rnjin            *
+ * (c) Rajin Shankar, 2019  *
+ *        rajinshankar.com  *
+ * *** ** *** ** *** ** *** */
+
+#pragma once
+#include <rnjin.hpp>
+
+#include <algorithm>
+#include <memory>
+
+#include "entity.hpp"
+#include "component.hpp"
+#include "world.hpp"
+
+#include "core/module.h"
+#include "reflection/module.h"
+
+namespace rnjin::ecs
+{
+    // Records structural changes (adding / removing components, destroying entities) to apply later, all at once
+    // ex. during an update: `changes.add<my_component>( owner, 1 );`, then at a sync point: `changes.apply();`
+    // note: changes to each component type are applied together, so a sorted component list is rebuilt once, rather
+    //       than once per change (see component::apply_deferred_changes)
+    // note: entities must outlive the changes recorded for them (or be discarded from the buffer first)
+    // note: a buffer records changes to entities of a single world
+    class command_buffer
+    {
+        public: // methods
+        // Record changes to entities of the world that's current on this thread
+        command_buffer();
+        // Record changes to entities of a given world
+        command_buffer( world& target_world );
+        ~command_buffer();
+        no_copy( command_buffer );
+
+        // Record adding a component to an entity
+        // note: arguments are copied until the change is applied
+        template <typename component_type, typename... arg_types>
+        void add( entity& owner, arg_types... args )
+        {
+            check_error_condition( return, ecs_log_errors, &owner.get_world() != &target_world, "Can't record adding component '\2' to an entity of another world (\1)", owner.get_id(), reflection::get_type_name<component_type>() );
+
+            let_mutable& changes = get_changes<component_type>();
+            check_error_condition( return, ecs_log_errors, changes.find_addition( owner ) != changes.additions.end(), "Can't add multiple instances of the same component '\2' to an entity (\1)", owner.get_id(),
+                                          reflection::get_type_name<component_type>() );
+
+            entity* owner_pointer = &owner;
+            changes.additions.push_back( { owner_pointer, [owner_pointer, args...]( list<typename component_type::owned_component>& target ) { target.emplace_back( *owner_pointer, args... ); } } );
+        }
+
+        // Reserve space for recording a number of additions of a component type
+        // note: used when handling a batch of events (ex. component::component_events::added_batch)
+        template <typename component_type>
+        void reserve_additions( const usize count )
+        {
+            let_mutable& changes = get_changes<component_type>();
+            changes.additions.reserve( changes.additions.size() + count );
+        }
+
+        // Record removing a component from an entity
+        // note: removing a component added in the same buffer just cancels the addition
+        template <typename component_type>
+        void remove( entity& owner )
+        {
+            check_error_condition( return, ecs_log_errors, &owner.get_world() != &target_world, "Can't record removing component '\2' from an entity of another world (\1)", owner.get_id(), reflection::get_type_name<component_type>() );
+
+            let_mutable& changes = get_changes<component_type>();
+
+            let addition = changes.find_addition( owner );
+            if ( addition != changes.additions.end() )
+            {
+                changes.additions.erase( addition );
+                return;
+            }
+
+            let is_already_removed = std::find( changes.removals.begin(), changes.removals.end(), &owner ) != changes.removals.end();
+            check_error_condition( return, ecs_log_errors, is_already_removed, "Component '\2' is already being removed from entity (\1)", owner.get_id(), reflection::get_type_name<component_type>() );
+
+            changes.removals.push_back( &owner );
+        }
+
+        // Record destroying an entity that was created with `new`, after all component changes are applied
+        // note: any changes already recorded for the entity are discarded
+        void destroy( entity* target );
+
+        // Forget all changes recorded for an entity (ex. when it is destroyed before they are applied)
+        // returns true if there were any changes to forget
+        bool discard( const entity& target );
+
+        // Apply all recorded changes, grouped by component type (in the order each type was first used)
+        void apply();
+
+        public: // accessors
+        bool is_empty() const;
+        let_mutable& get_world get_value( target_world );
+
+        private: // types
+        // Recorded changes to a single component type, as known by the buffer
+        class deferred_changes_base
+        {
+            public: // methods
+            virtual ~deferred_changes_base() {}
+
+            virtual void apply( world& target_world ) pure_virtual;
+            virtual bool discard( const entity& target ) pure_virtual;
+            virtual bool is_empty() const pure_virtual;
+        };
+
+        template <typename component_type>
+        class deferred_changes : public deferred_changes_base
+        {
+            public: // types
+            using deferred_addition = typename component_type::deferred_addition;
+
+            public: // methods
+            void apply( world& target_world ) override
+            {
+                if ( is_empty() )
+                {
+                    return;
+                }
+
+                // note: changes recorded while these are applied (ex. by event handlers) are kept for the next apply
+                list<deferred_addition> applied_additions = std::move( additions );
+                list<entity*> applied_removals            = std::move( removals );
+                additions.clear();
+                removals.clear();
+
+                command_buffer::apply_changes<component_type>( target_world, applied_additions, applied_removals );
+            }
+
+            bool discard( const entity& target ) override
+            {
+                let previous_count = additions.size() + removals.size();
+
+                additions.erase( std::remove_if( additions.begin(), additions.end(), [&]( const deferred_addition& addition ) { return addition.owner == &target; } ), additions.end() );
+                removals.erase( std::remove( removals.begin(), removals.end(), &target ), removals.end() );
+
+                return additions.size() + removals.size() != previous_count;
+            }
+
+            bool is_empty() const override
+            {
+                return additions.empty() and removals.empty();
+            }
+
+            typename list<deferred_addition>::iterator find_addition( const entity& owner )
+            {
+                return std::find_if( additions.begin(), additions.end(), [&]( const deferred_addition& addition ) { return addition.owner == &owner; } );
+            }
+
+            public: // members
+            list<deferred_addition> additions;
+            list<entity*> removals;
+        };
+
+        private: // methods
+        // Get the recorded changes for a component type, creating an empty set of changes if needed
+        template <typename component_type>
+        deferred_changes<component_type>& get_changes()
+        {
+            let key = get_type_key<component_type>();
+            foreach ( entry : changes_by_type )
+            {
+                if ( entry.first == key )
+                {
+                    return static_cast<deferred_changes<component_type>&>( *entry.second );
+                }
+            }
+
+            changes_by_type.emplace_back( key, std::make_unique<deferred_changes<component_type>>() );
+            return static_cast<deferred_changes<component_type>&>( *changes_by_type.back().second );
+        }
+
+        // Apply changes to a component type, and keep each entity's owned component types up to date
+        template <typename component_type>
+        static void apply_changes( world& target_world, list<typename component_type::deferred_addition>& additions, const list<entity*>& removals )
+        {
+            component_type::apply_deferred_changes( target_world, additions, removals );
+
+            let* type_handle_pointer = component_type::get_type_handle_pointer();
+            foreach ( owner : removals )
+            {
+                owner->remove_component_type_handle( type_handle_pointer );
+            }
+            foreach ( addition : additions )
+            {
+                addition.owner->add_component_type_handle( type_handle_pointer );
+            }
+        }
+
+        private: // members
+        world& target_world;
+        list<std::pair<type_key, std::unique_ptr<deferred_changes_base>>> changes_by_type;
+        list<entity*> destroyed_entities;
+    };
+} // namespace rnjin::ecs
@@ -7,7 +7,15 @@
 #pragma once
 #include <rnjin.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+
 #include "entity.hpp"
+#include "paged_list.hpp"
+#include "world.hpp"
 
 #include "core/module.h"
 #include "reflection/module.h"
@@ -18,32 +26,154 @@ namespace rnjin::ecs
     /*                              Component Helpers                             */
     /* -------------------------------------------------------------------------- */
 
+    // Identifies a type at runtime (the address of a static unique to each type)
+    // note: used to compare the component types systems access, and to group deferred changes by component type
+    using type_key = const void*;
+
+    template <typename T>
+    type_key get_type_key()
+    {
+        static const char key = 0;
+        return &key;
+    }
+
+    // Layouts available for storing all components of a given type
+    // note: selected per component type, ex. `class MyComponent : public component<MyComponent, storage_mode::sparse_set> {...};`
+    enum class storage_mode
+    {
+        // Components are kept in a contiguous list sorted by owner id (default)
+        //      add / remove are O( log component_count ) to search + O( component_count ) to shift,
+        //      but systems can walk multiple sorted lists in lockstep
+        sorted,
+        // Components are kept packed in a contiguous (unordered) list, along with a table of owner id -> list index
+        //      add / remove / lookup are O( 1 ), removal moves the last component into the removed one's slot
+        sparse_set,
+        // Components are kept in fixed-size pages that are never moved, along with a table of owner id -> index (as with sparse_set)
+        //      add / remove / lookup are O( 1 ), and a component stays at the same address until it is removed, so pointers
+        //      to it (ex. from entity::get) can be kept across frames
+        // note: removal leaves a vacancy that the next addition reuses, which systems skip over, and paged components are
+        //       never updated in chunks (see system::update_chunk)
+        paged,
+    };
+
     // Wrappers for storing references to a component type, instead of individual components
     // (essentially enables virtual static methods)
     // note: used by entity to notify the component type when it is destroyed
     class component_type_handle_base
     {
         public:
+        component_type_handle_base( const string& type_name ) : type_index( register_component_type( this, type_name ) ) {}
+
+        // Get the component type's index in signatures
+        let get_type_index get_value( type_index );
+
         virtual void on_entity_destroyed( entity& destroyed_entity ) const pure_virtual;
+        // note: used by entity_batch to remove a component type from all of its entities (all in owner_world) at once
+        virtual void on_entities_destroyed( world& owner_world, const list<entity*>& destroyed_entities ) const pure_virtual;
+
+        private: // members
+        const component_type_index type_index;
     };
 
     template <typename T>
     class component_type_handle : public component_type_handle_base
     {
         public:
+        component_type_handle() : component_type_handle_base( reflection::get_type_name<T>() ) {}
+
         void on_entity_destroyed( entity& destroyed_entity ) const override
         {
             // note: this check is needed, as systems can set up event handlers
             //       that leave the entity's list of owned component types in an
             //       invalid state, thus resulting in invalid removals
-            if ( component<T>::is_owned_by( destroyed_entity ) )
+            if ( T::is_owned_by( destroyed_entity ) )
             {
                 // forward the call to a static method on the appropriate component type
-                component<T>::remove_from( destroyed_entity );
+                T::remove_from( destroyed_entity );
             }
         }
+
+        void on_entities_destroyed( world& owner_world, const list<entity*>& destroyed_entities ) const override
+        {
+            // note: skips entities that no longer own the component
+            T::remove_from_all( owner_world, destroyed_entities );
+        }
+    };
+
+    // Base type of archetypes, as known by the component types they own
+    // note: lets component types keep an archetype's packed range up to date as components are added and removed
+    //       (see archetype.hpp)
+    class archetype_base
+    {
+        public: // methods
+        archetype_base( const usize component_type_count ) : pass_member( component_type_count ), count( 0 ) {}
+        virtual ~archetype_base() {}
+
+        // Called by owned component types after a component has been added to an entity
+        virtual void on_component_added( const entity::id owner_id ) pure_virtual;
+        // Called by owned component types before a component is removed from an entity
+        virtual void on_component_removing( const entity::id owner_id ) pure_virtual;
+        // Called by owned component types after all of their components have been replaced (see component::restore)
+        virtual void on_components_restored() pure_virtual;
+
+        public: // accessors
+        let get_count get_value( count );
+        let get_component_type_count get_value( component_type_count );
+        let get_chunk_count get_value( ( count + chunk_size - 1 ) / chunk_size );
+
+        public: // constants
+        // Number of entities in each chunk of the packed range
+        static constexpr usize chunk_size = 1024;
+
+        protected: // members
+        const usize component_type_count;
+        // Number of entities packed at the front of each component type's list
+        usize count;
+    };
+
+    template <typename... component_types>
+    class archetype;
+
+    // A view of a list of entries, as delivered by batched events (see component::component_events)
+    // note: only valid while the event is being sent
+    template <typename T>
+    class entry_span
+    {
+        public: // methods
+        entry_span( const list<T>& entries ) : first( entries.data() ), count( entries.size() ) {}
+
+        const T& operator[]( const usize index ) const
+        {
+            return first[index];
+        }
+        const T* begin() const
+        {
+            return first;
+        }
+        const T* end() const
+        {
+            return first + count;
+        }
+
+        public: // accessors
+        let size get_value( count );
+
+        private: // members
+        const T* first;
+        usize count;
     };
 
+    // The bytes of a trivially copyable component, copied without constructing it
+    // note: used to capture and restore components in bulk (see snapshot.hpp)
+    template <typename T>
+    struct component_bytes
+    {
+        alignas( T ) byte data[sizeof( T )];
+    };
+
+    class command_buffer;
+    class entity_batch;
+
     // // Defined below
     // template <typename T>
     // class reference;
@@ -52,14 +182,16 @@ namespace rnjin::ecs
     /*                                  Component                                 */
     /* -------------------------------------------------------------------------- */
 
-    // Specializing the component type creates a new global manager for components of that type.
+    // Specializing the component type creates a new manager for components of that type, which keeps separate
+    // state (the component list, owners, slots, events) in each world the type is used in
     // General usage (for ease of use) would be `class MyComponent : public component<MyComponent> {...};`
 
     // note: alternatively, use the component_class macro `component_class( MyComponent ) {...};`
+    //       or `component_class_with_storage( MyComponent, sparse_set ) {...};` to select a storage_mode
 
     // note<1>: it would probably be better to not have a pointer to the owner on the component itself, but is currently
     //          available so systems can get easily get the owner of a component they're operating on
-    template <typename T>
+    template <typename T, storage_mode mode = storage_mode::sorted>
     class component
     {
         public: // methods
@@ -73,11 +205,25 @@ namespace rnjin::ecs
             owner_pointer = &owner;
         }
 
+        public: // methods
+        // Mark this component as changed, so systems filtering on changed<T> visit it in their next update
+        // note: writing through write_to<T> in a system marks components automatically, this is for other changes
+        void mark_changed() const
+        {
+            let_mutable& owner_world = get_owner().get_world();
+            let_mutable& state       = get_state( owner_world );
+            owned_component* owned   = get_owned_component( state, get_owner().get_id() );
+            check_error_condition( return, ecs_log_errors, owned == nullptr, "Can't mark a component '\1' that isn't attached to its owner as changed", reflection::get_type_name<T>() );
+
+            mark_component_changed( state, *owned, owner_world.get_change_tick() );
+        }
+
         public: // accessors
         // note: see <1>
         const entity& get_owner() const
         {
-            const static entity invalid_owner{};
+            // note: built against the default world, since a sentinel registered with a scoped world would outlive it
+            const static entity invalid_owner{ world::get_default() };
             check_error_condition( return invalid_owner, ecs_log_errors, owner_pointer == nullptr, "Component (\1) doesn't have a valid owner pointer", reflection::get_type_name<T>() );
 
             return *owner_pointer;
@@ -96,8 +242,10 @@ namespace rnjin::ecs
 
             template <typename... arg_types>
             owned_component( const entity& owner, arg_types... args )
-              : owner_id( owner.get_id() ), //
-                component_data( args... )   //
+              : owner_id( owner.get_id() ),                           //
+                slot_index( invalid_index ),                          //
+                changed_tick( owner.get_world().get_change_tick() ),  //
+                component_data( args... )                             //
             {
                 component_data.set_owner( owner );
             }
@@ -106,14 +254,42 @@ namespace rnjin::ecs
             public: // members, accessors
             T component_data;
             let get_owner_id get_value( owner_id );
+            let get_slot_index get_value( slot_index );
+            let get_changed_tick get_value( changed_tick );
 
             private: // members
+            friend component;
+
             entity::id owner_id;
+            // Index into the type's slot table, which references use to find this component wherever it moves
+            usize slot_index;
+            // The change tick when this component was added, or last written to / marked changed
+            change_tick changed_tick;
         };
 
+        // An addition recorded by a command buffer, which constructs the new component at the end of a list when applied
+        struct deferred_addition
+        {
+            entity* owner;
+            std::function<void( list<owned_component>& )> emplace;
+        };
+
+        // Number of components in each page with storage_mode::paged
+        static constexpr usize page_size = 1024;
+        // The pages components are kept in with storage_mode::paged
+        using component_pages = paged_list<owned_component, page_size>;
+
+        protected: // types
+        // Everything a world keeps for this component type (defined below)
+        class type_state;
+
         protected: // static methods (accessible to friend class entity)
         friend class entity;
         friend class component_type_handle<T>;
+        friend class command_buffer;
+        friend class entity_batch;
+        template <typename... component_types>
+        friend class archetype;
         // friend class reference<T>;
         // friend class reference<T>;
 
@@ -123,46 +299,61 @@ namespace rnjin::ecs
             return &handle;
         }
 
-        // Create a new component, adding it to the components global listing of all instances
+        // Create a new component, adding it to the listing of all instances in the owner's world
         // note: really struggles handling references as constructor arguments (to entities, etc.)
         //       so for now we just always use pointers and hope for the best :(
         // note: total complexity is
         //       O( log component_count )                   to find insert position
         //     + O( component_count )                       for list reallocation if needed
+        //     + O( component_count )                       to update the slots of components after the insert position
         //     + O( added_event_receiver_count )            to notify systems, etc. that a component has been added
-        //     + O( reference_count * log component_count ) to update potentially update pointers in all references
+        // note: with storage_mode::sparse_set, components are always appended (and with storage_mode::paged, constructed in
+        //       the first vacancy or appended), so only the event cost remains
         template <typename... arg_types>
         static void add_to( entity& owner, arg_types... args )
         {
-            let owner_id = owner.get_id();
+            let owner_id       = owner.get_id();
+            let_mutable& state = get_state( owner.get_world() );
 
             // let_mutable component_data = T( args... );
             // component_data.set_owner( owner );
 
             ecs_log_verbose.print( "Add component '\2' to entity (\1)", owner_id, reflection::get_type_name<T>() );
-            check_error_condition( return, ecs_log_errors, owners.count( owner_id ) > 0, "Can't add multiple instances of the same component '\2' to an entity (\1)", owner_id, reflection::get_type_name<T>() );
+            check_error_condition( return, ecs_log_errors, is_owned_by( state, owner ), "Can't add multiple instances of the same component '\2' to an entity (\1)", owner_id, reflection::get_type_name<T>() );
 
             // Keep track of the newly added component so we can notify others that it was added
             T* new_component;
 
-            // Keep track of where a component was inserted to so we can update reference indices if needed
-            bool components_shifted = false;
-            usize insert_index      = 0;
+            // Keep track of where a component was inserted to so we can update the slots of components after it
+            usize insert_index = 0;
 
+            // Sparse sets don't need to be kept in order, so new components always go at the end of the list
+            if constexpr ( mode == storage_mode::sparse_set )
+            {
+                state.components.emplace_back( owner, args... );
+                new_component = index_appended_component( state, owner_id );
+            }
+            // Pages never move their components, so new components are constructed where they'll stay
+            else if constexpr ( mode == storage_mode::paged )
+            {
+                new_component = index_placed_component( state, owner_id, state.components.emplace( owner, args... ) );
+            }
             // No components have been registered yet
-            if ( components.empty() )
+            else if ( state.components.empty() )
             {
                 // components.push_back( owned_component( owner_id, component_data ) );
-                components.emplace_back( owner, args... );
-                new_component = &components.back().component_data;
+                state.components.emplace_back( owner, args... );
+                new_component = &state.components.back().component_data;
+                insert_index  = state.components.size() - 1;
             }
             // New component should go at end of list
             // note: would be handled by binary search below, but this is a common case that can be easily optimized
-            else if ( owner_id > components.back().get_owner_id() )
+            else if ( owner_id > state.components.back().get_owner_id() )
             {
                 // components.push_back( owned_component( owner_id, component_data ) );
-                components.emplace_back( owner, args... );
-                new_component = &components.back().component_data;
+                state.components.emplace_back( owner, args... );
+                new_component = &state.components.back().component_data;
+                insert_index  = state.components.size() - 1;
             }
             // New component goes somewhere in the list, perform a
             // binary search to get the appropriate location to insert
@@ -170,11 +361,11 @@ namespace rnjin::ecs
             {
                 // such that the `components` list remains sorted by owner IDs
                 usize start = 0;
-                usize end   = components.size();
+                usize end   = state.components.size();
                 while ( start != end )
                 {
                     let middle    = start + ( end - start ) / 2;
-                    let middle_id = components.at( middle ).get_owner_id();
+                    let middle_id = state.components.at( middle ).get_owner_id();
                     if ( owner_id < middle_id )
                     {
                         // continue search in left side
@@ -197,28 +388,25 @@ namespace rnjin::ecs
                     }
                 }
 
-                components.emplace( components.begin() + start, owner, args... );
-                new_component = &components.at( start ).component_data;
-
-                components_shifted = true;
-                insert_index       = start;
+                state.components.emplace( state.components.begin() + start, owner, args... );
+                new_component = &state.components.at( start ).component_data;
+                insert_index  = start;
             }
 
             // Make sure the component was actually added
             check_error_condition( return, ecs_log_errors, new_component == nullptr, "Failed to create new component '\2' for entity (\1)", owner_id, reflection::get_type_name<T>() );
 
-            // Track the new owner
-            owners.insert( owner_id );
-
-            // If we insert a new component in the middle of the list, we need to notify references to update their indices
-            if ( components_shifted )
+            // Track the new owner, and give the new component (and any it shifted) slots pointing at their indices
+            // note: sparse sets track owners in their index table instead, and assign slots when indexing appended components
+            if constexpr ( mode == storage_mode::sorted )
             {
-                component<T>::reallocating_component_added_event.send( insert_index );
+                state.owners.insert( owner_id );
+                update_tracking( state, insert_index, state.components.size() );
             }
 
             // Potentially notify others that a component of type T has been added to an entity
-            // note: happens after reallocation event to preserve correct references
-            component<T>::events.added().send( *new_component, owner );
+            // note: happens after slots are updated so references to the new component are valid
+            send_added_events( state, 1, [&]( const usize ) { return added_entry{ new_component, &owner }; } );
         }
 
         // Check if this component type already has an entry associated with the given entity, if not, add one, otherwise just pass through
@@ -240,16 +428,19 @@ namespace rnjin::ecs
         }
 
         // Destroy the component associated with the provided entity
-        // note: currently always modifies the global listing of all instances, in the future
+        // note: currently always modifies the world's listing of all instances, in the future
         //       this should probably invalidate unowned components and reuse them for subsequent add_to calls
         // note: total complexity is
         //       O( log component_count )                   to find delete position
         //     + O( component_count )                       for list reallocation if needed
+        //     + O( component_count )                       to update the slots of components after the removed one
         //     + O( added_event_receiver_count )            to notify systems, etc. that a component has been removed
-        //     + O( reference_count * log component_count ) to update potentially update pointers in all references
+        // note: with storage_mode::sparse_set, the last component is moved into the removed slot instead of shifting the list,
+        //       and with storage_mode::paged, the removed component is destroyed where it is
         static void remove_from( entity& owner )
         {
-            let owner_id = owner.get_id();
+            let owner_id       = owner.get_id();
+            let_mutable& state = get_state( owner.get_world() );
 
             ecs_log_verbose.print( "Remove component '\2' from entity (\1)", owner_id, reflection::get_type_name<T>() );
 
@@ -257,338 +448,1227 @@ namespace rnjin::ecs
             // could be called on an entity that doesn't own this component, as it has already been removed by the entity's destructor.
             // ex. System removes B when A is removed:
             //     remove B in destructor -> remove A in destructor -> system tries to remove B again
-            if ( owner.is_being_destroyed() and owners.count( owner_id ) == 0 )
+            if ( owner.is_being_destroyed() and not is_owned_by( state, owner ) )
             {
                 ecs_log_verbose.print( "Component type '\2' has already been removed from destroyed entity (\1)", owner_id, reflection::get_type_name<T>() );
                 return;
             }
 
             // Check if no components have been registered yet
-            check_error_condition( return, ecs_log_errors, components.empty(), "Component type '\2' is not attached to any entities, can't remove (\1)", owner_id, reflection::get_type_name<T>() );
+            check_error_condition( return, ecs_log_errors, state.components.empty(), "Component type '\2' is not attached to any entities, can't remove (\1)", owner_id, reflection::get_type_name<T>() );
             // Check that the entity is actually an owner
-            check_error_condition( return, ecs_log_errors, owners.count( owner_id ) == 0, "Can't remove component '\2' from an entity it's not attached to (\1)", owner_id, reflection::get_type_name<T>() );
-
-            // Remove the entity from the set of owners
-            owners.erase( owner_id );
+            check_error_condition( return, ecs_log_errors, not is_owned_by( state, owner ), "Can't remove component '\2' from an entity it's not attached to (\1)", owner_id, reflection::get_type_name<T>() );
 
-            // Keep track of where a component was removed from so we can update reference indices if needed
-            bool components_shifted = false;
-            usize removal_index     = 0;
-
-            // Associated component is at end of list
-            // note: would be handled by binary search below, but this is a common case that can be easily optimized
-            if ( owner_id == components.back().get_owner_id() )
+            // Sparse sets keep the list packed by moving the last component into the removed component's slot, and pages
+            // leave a vacancy where the removed component was
+            if constexpr ( mode != storage_mode::sorted )
             {
                 // Potentially notify others that a component of type T has been removed from an entity (before it is destroyed)
-                events.removed().send( components.back().component_data, owner );
-                components.pop_back();
+                send_removing_events( state, 1, [&]( const usize ) { return removed_entry{ owned_by( state, owner ), &owner }; } );
+
+                // note: handlers can remove the component themselves
+                if ( is_owned_by( state, owner ) )
+                {
+                    remove_unsorted( state, owner_id );
+                }
             }
-            // New component is somewhere in the list, perform a
-            // binary search to get the appropriate location to remove
-            // such that the `components` list remains sorted by owner IDs
             else
             {
-                usize start = 0;
-                usize end   = components.size();
-                while ( start != end )
+                // Remove the entity from the set of owners
+                state.owners.erase( owner_id );
+
+                // Associated component is at end of list
+                // note: would be handled by binary search below, but this is a common case that can be easily optimized
+                if ( owner_id == state.components.back().get_owner_id() )
                 {
-                    let middle    = start + ( end - start ) / 2;
-                    let middle_id = components.at( middle ).get_owner_id();
-                    if ( owner_id < middle_id )
+                    // Potentially notify others that a component of type T has been removed from an entity (before it is destroyed)
+                    send_removing_events( state, 1, [&]( const usize ) { return removed_entry{ &state.components.back().component_data, &owner }; } );
+                    release_slot( state, state.components.size() - 1 );
+                    state.components.pop_back();
+                }
+                // New component is somewhere in the list, perform a
+                // binary search to get the appropriate location to remove
+                // such that the `components` list remains sorted by owner IDs
+                else
+                {
+                    usize start = 0;
+                    usize end   = state.components.size();
+                    while ( start != end )
                     {
-                        // continue search in left side
-                        end = middle;
+                        let middle    = start + ( end - start ) / 2;
+                        let middle_id = state.components.at( middle ).get_owner_id();
+                        if ( owner_id < middle_id )
+                        {
+                            // continue search in left side
+                            end = middle;
+                        }
+                        else if ( owner_id > middle_id )
+                        {
+                            // continue search in right side
+                            start = middle + 1;
+                        }
+                        else
+                        {
+                            start = middle;
+                            break;
+                        }
                     }
-                    else if ( owner_id > middle_id )
+
+                    if ( owner_id == state.components.at( start ).get_owner_id() )
                     {
-                        // continue search in right side
-                        start = middle + 1;
+                        // Potentially notify others that a component of type T has been removed from an entity (before it is destroyed)
+                        send_removing_events( state, 1, [&]( const usize ) { return removed_entry{ &state.components.at( start ).component_data, &owner }; } );
+                        release_slot( state, start );
+                        state.components.erase( state.components.begin() + start );
+
+                        // Components after the removed one have shifted, so their slots need to follow them
+                        update_tracking( state, start, state.components.size() );
                     }
                     else
                     {
-                        start = middle;
-                        break;
+                        let owner_id_not_found = true;
+                        check_error_condition( pass, ecs_log_errors, owner_id_not_found == true, "Component '\2' not associated with entity (\1)", owner_id, reflection::get_type_name<T>() );
                     }
                 }
+            }
+        }
 
-                if ( owner_id == components.at( start ).get_owner_id() )
-                {
-                    // Potentially notify others that a component of type T has been removed from an entity (before it is destroyed)
-                    events.removed().send( components.at( start ).component_data, owner );
-                    components.erase( components.begin() + start );
+        // Apply additions and removals recorded by a command buffer all at once (removals first)
+        // note: called by command_buffer::apply, which also keeps each entity's owned component types up to date
+        // note: with storage_mode::sorted, everything after the first changed index is rebuilt (and has its slots updated)
+        //       in a single merge, so the total complexity is
+        //       O( addition_count * log addition_count ) to sort additions
+        //     + O( component_count )                       to rebuild the list
+        //       rather than O( component_count ) for each individual addition / removal
+        // note: with storage_mode::sparse_set or storage_mode::paged, nothing is shifted, so changes are applied one at a time
+        static void apply_deferred_changes( world& target_world, list<deferred_addition>& additions, const list<entity*>& removals )
+        {
+            let_mutable& state = get_state( target_world );
 
-                    components_shifted = true;
-                    removal_index      = start;
+            if constexpr ( mode != storage_mode::sorted )
+            {
+                // Notify others that components are being removed before any are destroyed
+                foreach ( owner : removals )
+                {
+                    check_error_condition( pass, ecs_log_errors, not is_owned_by( state, *owner ), "Can't remove component '\2' from an entity it's not attached to (\1)", owner->get_id(), reflection::get_type_name<T>() );
                 }
-                else
+                send_removing_events( state, removals.size(), [&]( const usize i ) { return removed_entry{ owned_by( state, *removals[i] ), removals[i] }; } );
+                foreach ( owner : removals )
                 {
-                    let owner_id_not_found = true;
-                    check_error_condition( pass, ecs_log_errors, owner_id_not_found == true, "Component '\2' not associated with entity (\1)", owner_id, reflection::get_type_name<T>() );
+                    if ( is_owned_by( state, *owner ) )
+                    {
+                        remove_unsorted( state, owner->get_id() );
+                    }
                 }
-            }
 
-            // If we remove a component in the middle of the list, we need to notify references to update their indices
-            if ( components_shifted )
+                // Skip entities that already own a component
+                additions.erase( std::remove_if( additions.begin(), additions.end(),
+                                                 [&]( const deferred_addition& addition ) {
+                                                     check_error_condition( return true, ecs_log_errors, is_owned_by( state, *addition.owner ), "Can't add multiple instances of the same component '\2' to an entity (\1)", addition.owner->get_id(), reflection::get_type_name<T>() );
+                                                     return false;
+                                                 } ),
+                                 additions.end() );
+                add_unsorted(
+                    state, additions.size(),                                                      //
+                    [&]( const usize i ) { return additions[i].owner->get_id(); },                //
+                    [&]( list<owned_component>& target, const usize i ) { additions[i].emplace( target ); } );
+
+                // Potentially notify others that components of type T have been added to entities
+                send_added_events( state, additions.size(), [&]( const usize i ) { return added_entry{ owned_by( state, *additions[i].owner ), additions[i].owner }; } );
+            }
+            else
             {
-                component<T>::reallocating_component_removed_event.send( removal_index );
+                ecs_log_verbose.print( "Apply \1 deferred additions and \2 deferred removals of component '\3'", additions.size(), removals.size(), reflection::get_type_name<T>() );
+
+                // Notify others that components are being removed before any are destroyed
+                // note: handlers can remove other components of this type, so indices are only found afterwards
+                foreach ( owner : removals )
+                {
+                    check_error_condition( pass, ecs_log_errors, not is_owned_by( state, *owner ), "Can't remove component '\2' from an entity it's not attached to (\1)", owner->get_id(), reflection::get_type_name<T>() );
+                }
+                send_removing_events( state, removals.size(), [&]( const usize i ) { return removed_entry{ owned_by( state, *removals[i] ), removals[i] }; } );
+
+                // Everything before the first changed index stays where it is
+                let old_count       = state.components.size();
+                usize first_changed = old_count;
+
+                list<bool> is_removed( old_count, false );
+                foreach ( owner : removals )
+                {
+                    if ( is_owned_by( state, *owner ) )
+                    {
+                        let index         = index_owned_by( state, *owner );
+                        is_removed[index] = true;
+                        release_slot( state, index );
+                        first_changed     = std::min( first_changed, index );
+                        state.owners.erase( owner->get_id() );
+                    }
+                }
+
+                // Sort additions by owner so they can be merged into the list, skipping entities that already own a component
+                let by_owner_id = []( const deferred_addition& a, const deferred_addition& b ) { return a.owner->get_id() < b.owner->get_id(); };
+                std::stable_sort( additions.begin(), additions.end(), by_owner_id );
+                additions.erase( std::remove_if( additions.begin(), additions.end(),
+                                                 [&]( const deferred_addition& addition ) {
+                                                     check_error_condition( return true, ecs_log_errors, is_owned_by( state, *addition.owner ), "Can't add multiple instances of the same component '\2' to an entity (\1)", addition.owner->get_id(), reflection::get_type_name<T>() );
+                                                     return false;
+                                                 } ),
+                                 additions.end() );
+
+                if ( not additions.empty() )
+                {
+                    first_changed = std::min( first_changed, lower_bound_of( state, additions.front().owner->get_id() ) );
+                }
+
+                merge_additions(
+                    state, first_changed, is_removed, additions.size(),                            //
+                    [&]( const usize i ) { return additions[i].owner->get_id(); },                 //
+                    [&]( const usize i ) { additions[i].emplace( state.components ); } );
+
+                // Track the new owners, and point slots at the rebuilt part of the list (once for all changes)
+                foreach ( addition : additions )
+                {
+                    state.owners.insert( addition.owner->get_id() );
+                }
+                update_tracking( state, first_changed, state.components.size() );
+
+                // Potentially notify others that components of type T have been added to entities
+                send_added_events( state, additions.size(), [&]( const usize i ) { return added_entry{ owned_by( state, *additions[i].owner ), additions[i].owner }; } );
             }
         }
 
-        static T* owned_by( const entity& owner )
+        // Add components to many entities at once
+        // note: emplace( target, i ) appends the component for new_owners[i] to the target list
+        // note: every new owner must belong to target_world
+        // note: with storage_mode::sorted, the list is reserved once and the new components are merged in by owner id, so
+        //       the total complexity is
+        //       O( new_owner_count * log new_owner_count ) to sort new owners (skipped if they're already in order)
+        //     + O( component_count - first_changed )      to rebuild the list after the first new component
+        //       and new components with ids after every existing one (ex. entities created while no destroyed entity ids were free to reuse) are just appended
+        template <typename emplace_function>
+        static void add_to_all( world& target_world, const list<entity*>& new_owners, const emplace_function& emplace )
         {
-            let owner_id = owner.get_id();
+            let_mutable& state = get_state( target_world );
 
-            // check_error_condition( return nullptr, ecs_log_errors, owners.count( owner_id ) == 0, "No components are attached to entity (\1)", owner_id );
-            if ( owners.count( owner_id ) == 0 )
+            ecs_log_verbose.print( "Add \1 components '\2'", new_owners.size(), reflection::get_type_name<T>() );
+
+            // Indices of new owners that don't already own a component
+            list<usize> order;
+            order.reserve( new_owners.size() );
+            for ( usize i = 0; i < new_owners.size(); i++ )
             {
-                return nullptr;
+                check_error_condition( continue, ecs_log_errors, is_owned_by( state, *new_owners[i] ), "Can't add multiple instances of the same component '\2' to an entity (\1)", new_owners[i]->get_id(),
+                                              reflection::get_type_name<T>() );
+                order.push_back( i );
             }
 
-            // Associated component is at end of list
-            // note: would be handled by binary search below, but this is a common case that can be easily optimized
-            if ( owner_id == components.back().get_owner_id() )
+            // Sparse sets always append (and pages fill vacancies first), so only the list reservation is shared
+            if constexpr ( mode != storage_mode::sorted )
             {
-                return &( components.back().component_data );
+                add_unsorted(
+                    state, order.size(),                                                          //
+                    [&]( const usize k ) { return new_owners[order[k]]->get_id(); },              //
+                    [&]( list<owned_component>& target, const usize k ) { emplace( target, order[k] ); } );
             }
-            // Associated component is somewhere in the list, perform a
-            // binary search to get the appropriate location to return
             else
             {
-                uint start = 0;
-                uint end   = components.size();
-                while ( start != end )
+                let by_owner_id = [&]( const usize a, const usize b ) { return new_owners[a]->get_id() < new_owners[b]->get_id(); };
+                if ( not std::is_sorted( order.begin(), order.end(), by_owner_id ) )
                 {
-                    let middle    = start + ( end - start ) / 2;
-                    let middle_id = components.at( middle ).get_owner_id();
-                    if ( owner_id < middle_id )
-                    {
-                        // continue search in left side
-                        end = middle;
-                    }
-                    else if ( owner_id > middle_id )
-                    {
-                        // continue search in right side
-                        start = middle + 1;
-                    }
-                    else
-                    {
-                        start = middle;
-                        break;
-                    }
+                    std::sort( order.begin(), order.end(), by_owner_id );
+                }
+
+                let first_changed = order.empty() ? state.components.size() : lower_bound_of( state, new_owners[order.front()]->get_id() );
+                merge_additions(
+                    state, first_changed, {}, order.size(),                                //
+                    [&]( const usize k ) { return new_owners[order[k]]->get_id(); },       //
+                    [&]( const usize k ) { emplace( state.components, order[k] ); } );
+
+                state.owners.reserve( state.owners.size() + order.size() );
+                foreach ( i : order )
+                {
+                    state.owners.insert( new_owners[i]->get_id() );
                 }
+                update_tracking( state, first_changed, state.components.size() );
+            }
+
+            // Potentially notify others that components of type T have been added to entities
+            send_added_events( state, order.size(), [&]( const usize k ) { return added_entry{ owned_by( state, *new_owners[order[k]] ), new_owners[order[k]] }; } );
+        }
+
+        // Remove the components owned by many entities at once, skipping entities that don't own one
+        // note: with storage_mode::sorted, the list is compacted in a single pass (see apply_deferred_changes)
+        static void remove_from_all( world& target_world, const list<entity*>& old_owners )
+        {
+            let_mutable& state = get_state( target_world );
 
-                if ( owner_id == components.at( start ).get_owner_id() )
+            list<entity*> removals;
+            removals.reserve( old_owners.size() );
+            foreach ( owner : old_owners )
+            {
+                if ( is_owned_by( state, *owner ) )
                 {
-                    return &( components.at( start ).component_data );
+                    removals.push_back( owner );
                 }
             }
 
-            return nullptr;
+            list<deferred_addition> no_additions;
+            apply_deferred_changes( target_world, no_additions, removals );
+        }
+
+        static T* owned_by( const entity& owner )
+        {
+            return owned_by( get_state( owner.get_world() ), owner );
+        }
+        static T* owned_by( type_state& state, const entity& owner )
+        {
+            owned_component* owned = get_owned_component( state, owner.get_id() );
+            return owned == nullptr ? nullptr : &( owned->component_data );
         }
 
         static bool is_owned_by( const entity& owner )
         {
-            return owners.count( owner.get_id() ) > 0;
+            return is_owned_by( get_state( owner.get_world() ), owner );
+        }
+        static bool is_owned_by( type_state& state, const entity& owner )
+        {
+            if constexpr ( mode != storage_mode::sorted )
+            {
+                return sparse_index_of( state, owner.get_id() ) != invalid_index;
+            }
+
+            return state.owners.count( owner.get_id() ) > 0;
         }
 
         public: // static methods (used by systems)
+        // note: these act on the world that's current on the calling thread, which systems set to their own while updating
+
         // Get an iterator over all components associated with entities using constant references
-        static const_iterator<owned_component> get_const_iterator()
+        // note: with storage_mode::paged, the iterator skips vacancies
+        static auto get_const_iterator()
         {
-            return const_iterator<owned_component>( components );
+            if constexpr ( mode == storage_mode::paged )
+            {
+                return typename component_pages::const_iterator( get_state().components );
+            }
+            else
+            {
+                return const_iterator<owned_component>( get_state().components );
+            }
         }
 
         // Get an iterator over all components associated with entities using mutable references
-        static mutable_iterator<owned_component> get_mutable_iterator()
+        // note: with storage_mode::paged, the iterator skips vacancies
+        static auto get_mutable_iterator()
         {
-            return mutable_iterator<owned_component>( components );
+            if constexpr ( mode == storage_mode::paged )
+            {
+                return typename component_pages::mutable_iterator( get_state().components );
+            }
+            else
+            {
+                return mutable_iterator<owned_component>( get_state().components );
+            }
         }
 
+        // Get a pointer to the start of the list of all components of this type
+        // note: used by systems to walk an archetype's packed range directly
+        // note: not available with storage_mode::paged, whose components aren't contiguous (see get_owned_component_pages)
+        static owned_component* get_owned_components()
+        {
+            return get_state().components.data();
+        }
 
-        public: // static members
-        // Events for easily performing actions on component add/remove
-        static group component_events
+        // Get the pages of all components of this type, with storage_mode::paged
+        // note: used by systems to walk the pages by index, skipping vacancies
+        static component_pages& get_owned_component_pages()
         {
-            public: // accessors
-            let_mutable& added get_mutable_value( component_added_event );
-            let_mutable& removed get_mutable_value( component_removed_event );
+            return get_state().components;
+        }
 
-            private: // members
-            event<T&, entity&> component_added_event{ "component added" };
-            event<const T&, entity&> component_removed_event{ "component removed" };
+        // Get the number of components of this type (ie the length of the list from get_owned_components)
+        // note: with storage_mode::paged, this is the range of indices in use, including vacancies
+        static usize get_owned_component_count()
+        {
+            return get_state().components.size();
         }
-        events;
 
-        protected: // static accessors
-        static usize index_owned_by( const entity& owner )
+        // Get this component type's index in entity signatures
+        // note: used by systems to build the signatures they match entities against
+        static component_type_index get_type_index()
         {
-            static let invalid_index = ~0;
+            return get_type_handle_pointer()->get_type_index();
+        }
 
-            let owner_id = owner.get_id();
+        // Get the archetype that keeps components of this type packed, if any
+        static archetype_base* get_owning_archetype()
+        {
+            return get_state().owning_archetype;
+        }
 
-            // Check that the entity is actually an owner
-            check_error_condition( return invalid_index, ecs_log_errors, owners.count( owner_id ) == 0, "Can't get index of component '\2' from an entity it's not attached to (\1)", owner_id,
-                                          reflection::get_type_name<T>() );
+        // Mark a component in the list as changed at the current change tick
+        // note: used by systems when a component is accessed through write_to<T>
+        static void mark_component_changed( owned_component& owned )
+        {
+            mark_component_changed( get_state(), owned, world::get_current().get_change_tick() );
+        }
 
-            // Associated component is at end of list
-            // note: would be handled by binary search below, but this is a common case that can be easily optimized
-            if ( owner_id == components.back().get_owner_id() )
+        // Mark the components in [first, last) of the list as changed at the current change tick
+        // note: used by systems when a chunk of components is accessed through write_to<T>
+        static void mark_components_changed( const usize first, const usize last )
+        {
+            let_mutable& state = get_state();
+            let tick           = world::get_current().get_change_tick();
+            for ( usize index = first; index < last; index++ )
             {
-                return components.size() - 1;
+                mark_component_changed( state, state.components[index], tick );
             }
-            // New component is somewhere in the list, perform a
-            // binary search to get the appropriate index
-            else
+        }
+
+        // Get the latest change tick of any component in a chunk of change_chunk_size components
+        // note: used by systems filtering on changed<T> to skip chunks that haven't changed since their last update
+        static change_tick get_chunk_changed_tick( const usize chunk_index )
+        {
+            let& state = get_state();
+            return chunk_index < state.changed_chunk_ticks.size() ? state.changed_chunk_ticks[chunk_index].tick.load( std::memory_order_relaxed ) : 0;
+        }
+
+        // Get the latest change tick of any component of this type
+        // note: used by observers watching for changes to skip the whole list when nothing has changed since their last update
+        static change_tick get_latest_changed_tick()
+        {
+            return get_state().latest_changed_tick.tick.load( std::memory_order_relaxed );
+        }
+
+        // Get the component associated with an entity (along with its owner id), or nullptr if the entity doesn't own one
+        // note: used by systems to look up components that can't be iterated in lockstep with others
+        static owned_component* get_owned_component( const entity::id owner_id )
+        {
+            return get_owned_component( get_state(), owner_id );
+        }
+
+        // Get the events sent when components of this type are added to or removed from entities of a given world
+        static let_mutable& get_events( world& target_world )
+        {
+            return get_state( target_world ).events;
+        }
+
+        public: // static methods (used by snapshots)
+        // Copy the owner id and bytes of every component of this type in a world, in list order
+        // note: used by snapshot, which writes each list with a single bulk write
+        static void capture( world& source_world, list<entity::id>& owner_ids, list<component_bytes<T>>& component_data )
+        {
+            static_assert( std::is_trivially_copyable_v<T>, "Only trivially copyable component types can be captured" );
+            let& state = get_state( source_world );
+
+            owner_ids.clear();
+            component_data.clear();
+            owner_ids.reserve( state.components.size() );
+            component_data.reserve( state.components.size() );
+            for ( usize index = 0; index < state.components.size(); index++ )
             {
-                uint start = 0;
-                uint end   = components.size();
-                while ( start != end )
+                if ( is_vacant( state, index ) )
                 {
-                    let middle    = start + ( end - start ) / 2;
-                    let middle_id = components.at( middle ).get_owner_id();
-                    if ( owner_id < middle_id )
-                    {
-                        // continue search in left side
-                        end = middle;
-                    }
-                    else if ( owner_id > middle_id )
-                    {
-                        // continue search in right side
-                        start = middle + 1;
-                    }
-                    else
-                    {
-                        start = middle;
-                        break;
-                    }
+                    continue;
                 }
 
-                if ( owner_id == components.at( start ).get_owner_id() )
-                {
-                    return start;
-                }
-                else
-                {
-                    let owner_id_not_found = true;
-                    check_error_condition( pass, ecs_log_errors, owner_id_not_found == true, "Component '\2' not associated with entity (\1)", owner_id, reflection::get_type_name<T>() );
-                    return invalid_index;
-                }
+                owner_ids.push_back( state.components[index].get_owner_id() );
+                component_data.emplace_back();
+                std::memcpy( component_data.back().data, &state.components[index].component_data, sizeof( T ) );
             }
         }
 
-        protected: // static members
-        // A contiguous array storing component data for efficient iteration
-        static list<owned_component> components;
-        // A set of owner id values, used to efficiently check if a given entity is an owner
-        static set<entity::id> owners;
-        // Events used specifically be component references
-        static event<usize> reallocating_component_added_event;
-        static event<usize> reallocating_component_removed_event;
-
-        /* -------------------------------------------------------------------------- */
-        /*                            Component References                            */
-        /* -------------------------------------------------------------------------- */
-        public:
-        class reference : public component<reference>
+        // Replace every component of this type in a world with captured ones, without sending added / removed events
+        // note: captured components whose owners have since been destroyed are skipped, and references to the replaced
+        //       components become invalid
+        // note: restored components count as changed at the world's current change tick
+        // note: total complexity is O( component_count + restored_count ), as the list is rebuilt in captured order
+        //       (already sorted by owner id with storage_mode::sorted) and slots are assigned once
+        static void restore( world& target_world, const list<entity::id>& owner_ids, const list<component_bytes<T>>& component_data )
         {
-            public: // methods
-            reference( const T* target_pointer )
-            {
-                set_target( target_pointer );
+            static_assert( std::is_trivially_copyable_v<T>, "Only trivially copyable component types can be restored" );
+            let_mutable& state = get_state( target_world );
+            let type_index     = get_type_index();
+
+            check_error_condition( return, ecs_log_errors, owner_ids.size() != component_data.size(), "Can't restore \1 components '\3' with \2 owner ids", component_data.size(), owner_ids.size(),
+                                          reflection::get_type_name<T>() );
+            ecs_log_verbose.print( "Restore \1 components '\2'", component_data.size(), reflection::get_type_name<T>() );
 
-                if ( not reference::handlers_initialized )
+            // Drop the current components, invalidating their slots and removing the type from their owners' signatures
+            for ( usize index = 0; index < state.components.size(); index++ )
+            {
+                if ( not is_vacant( state, index ) )
                 {
-                    reference::initialize_handlers();
+                    release_slot( state, index );
+                    target_world.get_mutable_signature( state.components[index].get_owner_id() ).reset( type_index );
                 }
             }
-            reference( const entity* target_owner_pointer )
+            state.components.clear();
+            state.owners.clear();
+            state.sparse_indices.clear();
+
+            state.components.reserve( component_data.size() );
+            for ( usize i = 0; i < component_data.size(); i++ )
             {
-                set_target_from_owner( target_owner_pointer );
+                let* owner = target_world.get_entity( owner_ids[i] );
+                check_error_condition( continue, ecs_log_errors, owner == nullptr, "Can't restore component '\2' of a destroyed entity (\1)", owner_ids[i], reflection::get_type_name<T>() );
 
-                if ( not reference::handlers_initialized )
+                // note: the captured owner pointer is replaced with the live owner's
+                let& captured = *reinterpret_cast<const T*>( component_data[i].data );
+                if constexpr ( mode == storage_mode::paged )
                 {
-                    reference::initialize_handlers();
+                    set_sparse_index( state, owner_ids[i], state.components.emplace( *owner, captured ) );
                 }
+                else if constexpr ( mode == storage_mode::sparse_set )
+                {
+                    state.components.emplace_back( *owner, captured );
+                    set_sparse_index( state, owner_ids[i], state.components.size() - 1 );
+                }
+                else
+                {
+                    state.components.emplace_back( *owner, captured );
+                    state.owners.insert( owner_ids[i] );
+                }
+                target_world.get_mutable_signature( owner_ids[i] ).set( type_index );
             }
-            reference( const reference& other ) : target_index( other.target_index ) {}
-            ~reference() {}
-
-            void set_target( const T* target_pointer )
-            {
-                let& target_owner = target_pointer->get_owner();
-                target_index      = T::index_owned_by( target_owner );
-            }
-            void set_target_from_owner( const entity* target_owner_pointer )
+            update_tracking( state, 0, state.components.size() );
+
+            // An owning archetype's packed range no longer matches the list, so it packs it again
+            if ( state.owning_archetype != nullptr )
             {
-                target_index = T::index_owned_by( *target_owner_pointer );
+                state.owning_archetype->on_components_restored();
             }
+        }
 
-            public: // accessors
-            const T* get_pointer() const
+        protected: // static methods
+        static owned_component* get_owned_component( type_state& state, const entity::id owner_id )
+        {
+            // Sparse sets (and pages) can look up the component's index directly
+            if constexpr ( mode != storage_mode::sorted )
             {
-                return &( component<T>::components[target_index].component_data );
+                let index = sparse_index_of( state, owner_id );
+                return index == invalid_index ? nullptr : &( state.components[index] );
             }
-            const entity& get_referenced_owner() const
+            else
             {
-                return get_pointer()->get_owner();
+                // check_error_condition( return nullptr, ecs_log_errors, owners.count( owner_id ) == 0, "No components are attached to entity (\1)", owner_id );
+                if ( state.owners.count( owner_id ) == 0 )
+                {
+                    return nullptr;
+                }
+
+                // Associated component is at end of list
+                // note: would be handled by binary search below, but this is a common case that can be easily optimized
+                if ( owner_id == state.components.back().get_owner_id() )
+                {
+                    return &( state.components.back() );
+                }
+                // Associated component is somewhere in the list, perform a
+                // binary search to get the appropriate location to return
+                else
+                {
+                    uint start = 0;
+                    uint end   = state.components.size();
+                    while ( start != end )
+                    {
+                        let middle    = start + ( end - start ) / 2;
+                        let middle_id = state.components.at( middle ).get_owner_id();
+                        if ( owner_id < middle_id )
+                        {
+                            // continue search in left side
+                            end = middle;
+                        }
+                        else if ( owner_id > middle_id )
+                        {
+                            // continue search in right side
+                            start = middle + 1;
+                        }
+                        else
+                        {
+                            start = middle;
+                            break;
+                        }
+                    }
+
+                    if ( owner_id == state.components.at( start ).get_owner_id() )
+                    {
+                        return &( state.components.at( start ) );
+                    }
+                }
+
+                return nullptr;
             }
+        }
+
+        public: // constants
+        // Whether components are stored in order of their owners' ids
+        // note: used by systems to determine if multiple component lists can be walked in lockstep
+        static constexpr bool is_sorted_by_owner = mode == storage_mode::sorted;
+        static constexpr storage_mode storage    = mode;
+        static constexpr usize invalid_index     = ~usize( 0 );
+        // Number of components sharing a change tick, for systems to skip unchanged components quickly
+        static constexpr usize change_chunk_size = 64;
+
 
-            inline let is_valid get_value( target_index != invalid_index );
+        public: // types
+        // A component and its owner, as delivered by batched events
+        template <typename component_type>
+        group event_entry
+        {
+            component_type* component;
+            entity* owner;
+        };
+        using added_entry   = event_entry<T>;
+        using removed_entry = event_entry<const T>;
+        using added_span    = entry_span<added_entry>;
+        using removed_span  = entry_span<removed_entry>;
+
+        // Events for easily performing actions on component add/remove
+        // note: each world has its own (see get_events)
+        // note: added / removed are sent once per component, then added_batch / removed_batch once for all components
+        //       added or removed by the same operation (ex. entity_batch::add, command_buffer::apply), so handlers that
+        //       only collect new components can reserve space and make one call per operation instead of one per component
+        // note: batched handlers must not add or remove components of the same type directly (use a command_buffer),
+        //       since that would move the components in the span
+        group component_events
+        {
+            public: // accessors
+            let_mutable& added get_mutable_value( component_added_event );
+            let_mutable& removed get_mutable_value( component_removed_event );
+            let_mutable& added_batch get_mutable_value( components_added_event );
+            let_mutable& removed_batch get_mutable_value( components_removed_event );
 
             private: // members
-            usize target_index;
+            event<T&, entity&> component_added_event{ "component added" };
+            event<const T&, entity&> component_removed_event{ "component removed" };
+            event<const added_span&> components_added_event{ "components added" };
+            event<const removed_span&> components_removed_event{ "components removed" };
+        };
 
-            private: // static methods
-            static void on_component_added( usize insert_index )
+        public: // static members
+        // The events of the world that's current on the calling thread (ex. when a system subscribes to them)
+        static group current_world_events
+        {
+            public: // accessors
+            event<T&, entity&>& added()
+            {
+                return get_state().events.added();
+            }
+            event<const T&, entity&>& removed()
             {
-                ecs_log_verbose.print( "Update reference indices for '\1' (on add)", reflection::get_type_name<T>() );
+                return get_state().events.removed();
+            }
+            event<const added_span&>& added_batch()
+            {
+                return get_state().events.added_batch();
+            }
+            event<const removed_span&>& removed_batch()
+            {
+                return get_state().events.removed_batch();
+            }
+        }
+        events;
+
+        protected: // static accessors
+        static usize index_owned_by( type_state& state, const entity& owner )
+        {
+            let owner_id = owner.get_id();
+
+            // Check that the entity is actually an owner
+            check_error_condition( return invalid_index, ecs_log_errors, not is_owned_by( state, owner ), "Can't get index of component '\2' from an entity it's not attached to (\1)", owner_id,
+                                          reflection::get_type_name<T>() );
 
-                for ( nonconst auto& c : reference::components )
+            // Sparse sets (and pages) can look up the component's index directly
+            if constexpr ( mode != storage_mode::sorted )
+            {
+                return sparse_index_of( state, owner_id );
+            }
+            else
+            {
+                // Associated component is at end of list
+                // note: would be handled by binary search below, but this is a common case that can be easily optimized
+                if ( owner_id == state.components.back().get_owner_id() )
                 {
-                    // All indices after the insertion position need to be incremented
-                    if ( c.component_data.target_index >= insert_index )
+                    return state.components.size() - 1;
+                }
+                // New component is somewhere in the list, perform a
+                // binary search to get the appropriate index
+                else
+                {
+                    uint start = 0;
+                    uint end   = state.components.size();
+                    while ( start != end )
+                    {
+                        let middle    = start + ( end - start ) / 2;
+                        let middle_id = state.components.at( middle ).get_owner_id();
+                        if ( owner_id < middle_id )
+                        {
+                            // continue search in left side
+                            end = middle;
+                        }
+                        else if ( owner_id > middle_id )
+                        {
+                            // continue search in right side
+                            start = middle + 1;
+                        }
+                        else
+                        {
+                            start = middle;
+                            break;
+                        }
+                    }
+
+                    if ( owner_id == state.components.at( start ).get_owner_id() )
                     {
-                        c.component_data.target_index += 1;
+                        return start;
+                    }
+                    else
+                    {
+                        let owner_id_not_found = true;
+                        check_error_condition( pass, ecs_log_errors, owner_id_not_found == true, "Component '\2' not associated with entity (\1)", owner_id, reflection::get_type_name<T>() );
+                        return invalid_index;
                     }
                 }
             }
+        }
 
-            // note: this will only be called for reallocating removals, so removing the last component in the list will not warn about invalidating active references
-            //       we should probably have dedicated events for those cases in case they need to be handled for warning / etc.
-            static void on_component_removed( usize remove_index )
+        private: // static helpers (events)
+        // Notify others that components of type T have been added to entities, with one event per component, then one
+        // batch of all of them
+        // note: entry_at( i ) gets the i-th new component and its owner, and is called again for the batch, since
+        //       handlers of the first events can move or remove components (entries without a component are skipped)
+        // note: no batch is sent when nothing is left in it
+        template <typename entry_function>
+        static void send_added_events( type_state& state, const usize count, const entry_function& entry_at )
+        {
+            if ( count == 0 )
             {
-                ecs_log_verbose.print( "Update reference indices for '\1' (on remove)", reflection::get_type_name<T>() );
+                return;
+            }
 
-                for ( nonconst auto& c : components )
+            if ( state.events.added().has_handlers() )
+            {
+                for ( usize i = 0; i < count; i++ )
                 {
-                    let invalidating_active_reference = c.component_data.target_index == remove_index;
+                    let entry = entry_at( i );
+                    if ( entry.component != nullptr )
+                    {
+                        state.events.added().send( *entry.component, *entry.owner );
+                    }
+                }
+            }
+
+            if ( state.events.added_batch().has_handlers() )
+            {
+                list<added_entry> entries;
+                entries.reserve( count );
+                for ( usize i = 0; i < count; i++ )
+                {
+                    let entry = entry_at( i );
+                    if ( entry.component != nullptr )
+                    {
+                        entries.push_back( entry );
+                    }
+                }
+                if ( not entries.empty() )
+                {
+                    state.events.added_batch().send( added_span( entries ) );
+                }
+            }
+        }
+
+        // Notify others that components of type T are about to be removed from entities (before any are destroyed),
+        // with one event per component, then one batch of all of them
+        // note: see send_added_events
+        template <typename entry_function>
+        static void send_removing_events( type_state& state, const usize count, const entry_function& entry_at )
+        {
+            if ( count == 0 )
+            {
+                return;
+            }
 
-                    // The component at an index currently being referenced is being removed, which is bad
-                    check_error_condition( continue, ecs_log_errors, invalidating_active_reference == true, "Destroying component '\1' with active references (index=\2)", reflection::get_type_name<T>(), remove_index );
+            if ( state.events.removed().has_handlers() )
+            {
+                for ( usize i = 0; i < count; i++ )
+                {
+                    let entry = entry_at( i );
+                    if ( entry.component != nullptr )
+                    {
+                        state.events.removed().send( *entry.component, *entry.owner );
+                    }
+                }
+            }
 
-                    // All indices after the deletion position need to be decremented
-                    if ( c.component_data.target_index > remove_index )
+            if ( state.events.removed_batch().has_handlers() )
+            {
+                list<removed_entry> entries;
+                entries.reserve( count );
+                for ( usize i = 0; i < count; i++ )
+                {
+                    let entry = entry_at( i );
+                    if ( entry.component != nullptr )
                     {
-                        c.component_data.target_index -= 1;
+                        entries.push_back( entry );
                     }
                 }
+                if ( not entries.empty() )
+                {
+                    state.events.removed_batch().send( removed_span( entries ) );
+                }
+            }
+        }
+
+        private: // static helpers (sparse_set storage)
+        // Get the index of the component owned by a given entity, or invalid_index if it doesn't own one
+        static usize sparse_index_of( type_state& state, const entity::id owner_id )
+        {
+            let key = owner_id.value();
+            return key < state.sparse_indices.size() ? state.sparse_indices[key] : invalid_index;
+        }
+
+        // Set the index of the component owned by a given entity, growing the table if needed
+        static void set_sparse_index( type_state& state, const entity::id owner_id, const usize index )
+        {
+            let key = owner_id.value();
+            if ( key >= state.sparse_indices.size() )
+            {
+                state.sparse_indices.resize( key + 1, invalid_index );
+            }
+            state.sparse_indices[key] = index;
+        }
+
+        // Index the component just appended to the list for a given owner, and get its data
+        // note: an owning archetype may move the new component into its packed range
+        static T* index_appended_component( type_state& state, const entity::id owner_id )
+        {
+            set_sparse_index( state, owner_id, state.components.size() - 1 );
+            update_tracking( state, state.components.size() - 1, state.components.size() );
+
+            if ( state.owning_archetype != nullptr )
+            {
+                state.owning_archetype->on_component_added( owner_id );
+            }
+
+            return &state.components[sparse_index_of( state, owner_id )].component_data;
+        }
+
+        // Remove the component owned by a given entity, moving the last component into its place
+        // note: events have already been sent, and an owning archetype moves the entity's components out of its packed range first
+        static void remove_by_swap( type_state& state, const entity::id owner_id )
+        {
+            if ( state.owning_archetype != nullptr )
+            {
+                state.owning_archetype->on_component_removing( owner_id );
+            }
+
+            let removal_index = sparse_index_of( state, owner_id );
+            let last_index    = state.components.size() - 1;
+
+            // Remove the entity from the table of owners, and invalidate references to the component
+            set_sparse_index( state, owner_id, invalid_index );
+            release_slot( state, removal_index );
+
+            // The last component is moved into the removed component's slot, and its slot follows it
+            if ( removal_index != last_index )
+            {
+                state.components[removal_index] = std::move( state.components.back() );
+                set_sparse_index( state, state.components[removal_index].get_owner_id(), removal_index );
+                update_tracking( state, removal_index, removal_index + 1 );
+            }
+            state.components.pop_back();
+        }
+
+        // Exchange the positions of two components in the list
+        // note: called by an owning archetype to move components into or out of its packed range
+        static void swap_components( type_state& state, const usize first_index, const usize second_index )
+        {
+            if ( first_index == second_index )
+            {
+                return;
+            }
+
+            std::swap( state.components[first_index], state.components[second_index] );
+            set_sparse_index( state, state.components[first_index].get_owner_id(), first_index );
+            set_sparse_index( state, state.components[second_index].get_owner_id(), second_index );
+
+            // Slots follow their components to their new indices
+            update_tracking( state, first_index, first_index + 1 );
+            update_tracking( state, second_index, second_index + 1 );
+        }
+
+        // Remove the component owned by a given entity without shifting others
+        // note: sparse sets move the last component into its place, and pages leave a vacancy
+        static void remove_unsorted( type_state& state, const entity::id owner_id )
+        {
+            if constexpr ( mode == storage_mode::paged )
+            {
+                remove_in_place( state, owner_id );
+            }
+            else
+            {
+                remove_by_swap( state, owner_id );
+            }
+        }
+
+        // Add components for a number of owners without shifting others, where emplace( target, i ) appends the i-th one
+        // to a target list
+        // note: sparse sets append them to the list directly, while pages have them built in a staging list first, then
+        //       moved to the places they'll stay in (vacancies first)
+        template <typename owner_id_function, typename emplace_function>
+        static void add_unsorted( type_state& state, const usize count, const owner_id_function& owner_id_at, const emplace_function& emplace )
+        {
+            if constexpr ( mode == storage_mode::paged )
+            {
+                list<owned_component> staged;
+                staged.reserve( count );
+                for ( usize i = 0; i < count; i++ )
+                {
+                    emplace( staged, i );
+                }
+
+                state.components.reserve( state.components.get_count() + count );
+                for ( usize i = 0; i < count; i++ )
+                {
+                    index_placed_component( state, owner_id_at( i ), state.components.emplace( std::move( staged[i] ) ) );
+                }
+            }
+            else
+            {
+                state.components.reserve( state.components.size() + count );
+                for ( usize i = 0; i < count; i++ )
+                {
+                    emplace( state.components, i );
+                    index_appended_component( state, owner_id_at( i ) );
+                }
+            }
+        }
+
+        private: // static helpers (paged storage)
+        // Index the component just placed in the pages for a given owner, and get its data
+        static T* index_placed_component( type_state& state, const entity::id owner_id, const usize index )
+        {
+            set_sparse_index( state, owner_id, index );
+            update_tracking( state, index, index + 1 );
+            return &state.components[index].component_data;
+        }
+
+        // Remove the component owned by a given entity, destroying it in place and leaving a vacancy for the next addition
+        // note: events have already been sent
+        static void remove_in_place( type_state& state, const entity::id owner_id )
+        {
+            let removal_index = sparse_index_of( state, owner_id );
+
+            // Remove the entity from the table of owners, and invalidate references to the component
+            set_sparse_index( state, owner_id, invalid_index );
+            release_slot( state, removal_index );
+            state.components.erase( removal_index );
+        }
+
+        // Check if an index in the list is a vacancy left by a removed component (only ever true with storage_mode::paged)
+        static bool is_vacant( const type_state& state, const usize index )
+        {
+            if constexpr ( mode == storage_mode::paged )
+            {
+                return not state.components.is_occupied( index );
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        private: // static helpers (sorted storage)
+        // Get the index of the first component whose owner id isn't less than the given id
+        static usize lower_bound_of( type_state& state, const entity::id owner_id )
+        {
+            if ( state.components.empty() or owner_id > state.components.back().get_owner_id() )
+            {
+                return state.components.size();
+            }
+
+            let position = std::lower_bound( state.components.begin(), state.components.end(), owner_id,
+                                             []( const owned_component& owned, const entity::id id ) { return owned.get_owner_id() < id; } );
+            return static_cast<usize>( position - state.components.begin() );
+        }
+
+        // Rebuild the list after first_changed, dropping removed components and merging in additions by owner id
+        // note: additions must be sorted by owner id, and emplace_addition( i ) appends the i-th one to the list
+        // note: is_removed holds a flag for each index in the list before the merge (or is empty if nothing is removed)
+        template <typename owner_id_function, typename emplace_function>
+        static void merge_additions( type_state& state, const usize first_changed, const list<bool>& is_removed, const usize addition_count, const owner_id_function& addition_owner_id,
+                                     const emplace_function& emplace_addition )
+        {
+            let old_count = state.components.size();
+
+            // Move the changed part of the list aside, then merge it back together with the additions
+            list<owned_component> previous_tail;
+            previous_tail.reserve( old_count - first_changed );
+            std::move( state.components.begin() + first_changed, state.components.end(), std::back_inserter( previous_tail ) );
+            state.components.erase( state.components.begin() + first_changed, state.components.end() );
+            state.components.reserve( old_count + addition_count );
+
+            usize next_addition = 0;
+            for ( usize tail_index = 0; tail_index < previous_tail.size(); tail_index++ )
+            {
+                if ( not is_removed.empty() and is_removed[first_changed + tail_index] )
+                {
+                    continue;
+                }
+
+                let_mutable& owned = previous_tail[tail_index];
+                while ( next_addition < addition_count and addition_owner_id( next_addition ) < owned.get_owner_id() )
+                {
+                    emplace_addition( next_addition );
+                    next_addition += 1;
+                }
+
+                state.components.push_back( std::move( owned ) );
+            }
+            while ( next_addition < addition_count )
+            {
+                emplace_addition( next_addition );
+                next_addition += 1;
+            }
+        }
+
+        private: // static helpers (slots, change ticks)
+        // Point the slots of components in [first, last) at their current indices, giving new components a slot first,
+        // and raise the change ticks of the chunks they're now in to their own
+        // note: called whenever components are added or moved, so references never need to be told about it
+        static void update_tracking( type_state& state, const usize first, const usize last )
+        {
+            let chunk_count = ( last + change_chunk_size - 1 ) / change_chunk_size;
+            if ( state.changed_chunk_ticks.size() < chunk_count )
+            {
+                state.changed_chunk_ticks.resize( chunk_count );
+            }
+
+            for ( usize index = first; index < last; index++ )
+            {
+                if ( is_vacant( state, index ) )
+                {
+                    continue;
+                }
+
+                let_mutable& owned = state.components[index];
+                if ( owned.slot_index == invalid_index )
+                {
+                    owned.slot_index = allocate_slot( state );
+                }
+                state.slots[owned.slot_index].index = index;
+                raise_chunk_tick( state, index, owned.changed_tick );
             }
+        }
 
-            // Set up handlers for components being added / removed
-            // note: this is called on first instantiation of a reference type,
-            //       since sequence of memory allocation isn't handled well yet
-            static void initialize_handlers()
+        // Record a change to a component at a given tick
+        static void mark_component_changed( type_state& state, owned_component& owned, const change_tick tick )
+        {
+            owned.changed_tick = tick;
+
+            // Pages aren't contiguous, so the component's index is found through its slot instead
+            if constexpr ( mode == storage_mode::paged )
             {
-                ecs_log_verbose.print( "Initialize reference handlers for '\1'", reflection::get_type_name<T>() );
+                raise_chunk_tick( state, state.slots[owned.slot_index].index, tick );
+            }
+            else
+            {
+                raise_chunk_tick( state, static_cast<usize>( &owned - state.components.data() ), tick );
+            }
+        }
 
-                component_added_handler.set( component<T>::reallocating_component_added_event, on_component_added );
-                component_removed_handler.set( component<T>::reallocating_component_removed_event, on_component_removed );
+        // Raise the change tick of the chunk containing an index (and the latest tick of the whole type), if the given
+        // tick is later
+        // note: the type's tick is only raised along with a chunk's, so it's touched once per chunk per tick rather than
+        //       once per component
+        static void raise_chunk_tick( type_state& state, const usize index, const change_tick tick )
+        {
+            if ( raise_tick( state.changed_chunk_ticks[index / change_chunk_size].tick, tick ) )
+            {
+                raise_tick( state.latest_changed_tick.tick, tick );
             }
+        }
 
-            private: // static members
-            static bool handlers_initialized;
-            static static_event_handler<usize> component_added_handler;
-            static static_event_handler<usize> component_removed_handler;
+        // Raise an atomic tick to a given tick if it's later, returning whether it was
+        // note: a compare-exchange, since batches of a parallel update can mark components in the same chunk
+        static bool raise_tick( std::atomic<change_tick>& target_tick, const change_tick tick )
+        {
+            change_tick current_tick = target_tick.load( std::memory_order_relaxed );
+            while ( current_tick < tick )
+            {
+                if ( target_tick.compare_exchange_weak( current_tick, tick, std::memory_order_relaxed ) )
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Get an unused slot, reusing released slots first
+        static usize allocate_slot( type_state& state )
+        {
+            if ( not state.free_slots.empty() )
+            {
+                let slot_index = state.free_slots.back();
+                state.free_slots.pop_back();
+                return slot_index;
+            }
+
+            state.slots.push_back( slot{ invalid_index, 0 } );
+            return state.slots.size() - 1;
+        }
+
+        // Release the slot of a component that is about to be destroyed
+        // note: the slot's generation changes, so references to the destroyed component become invalid
+        static void release_slot( type_state& state, const usize index )
+        {
+            let slot_index = state.components[index].slot_index;
+            if ( slot_index == invalid_index )
+            {
+                return;
+            }
+
+            state.slots[slot_index].index = invalid_index;
+            state.slots[slot_index].generation += 1;
+            state.free_slots.push_back( slot_index );
+        }
+
+        // Get the index of the component in a slot, or invalid_index if the slot's component is gone
+        static usize resolve_slot( type_state& state, const usize slot_index, const uint generation )
+        {
+            if ( slot_index >= state.slots.size() or state.slots[slot_index].generation != generation )
+            {
+                return invalid_index;
+            }
+            return state.slots[slot_index].index;
+        }
+
+        private: // types
+        // The latest change tick of any component in a chunk of the list
+        // note: copyable so the list of chunks can grow (only done outside of system updates)
+        struct chunk_change_tick
+        {
+            chunk_change_tick() : tick( 0 ) {}
+            chunk_change_tick( const chunk_change_tick& other ) : tick( other.tick.load( std::memory_order_relaxed ) ) {}
+
+            std::atomic<change_tick> tick;
+        };
+
+        // An indirection from stable slot indices to current component indices
+        // note: generation is incremented each time the slot's component is destroyed
+        struct slot
+        {
+            usize index;
+            uint generation;
+        };
+
+        protected: // types
+        // Everything a world keeps for this component type
+        class type_state : public component_storage_base
+        {
+            public: // members
+            // A contiguous array storing component data for efficient iteration
+            // note: pages with stable addresses instead with storage_mode::paged
+            std::conditional_t<mode == storage_mode::paged, component_pages, list<owned_component>> components;
+            // A set of owner id values, used to efficiently check if a given entity is an owner
+            // note: only used with storage_mode::sorted
+            set<entity::id> owners;
+            // A table of owner id value -> index into components, invalid_index for non-owners
+            // note: only used with storage_mode::sparse_set and storage_mode::paged
+            list<usize> sparse_indices;
+            // The archetype that keeps this type's components packed with other types', if any
+            // note: only used with storage_mode::sparse_set
+            archetype_base* owning_archetype = nullptr;
+            // A table of slot index -> component index (and generation), used by references to find components
+            list<slot> slots;
+            // Slots that have been released, to be reused by new components
+            list<usize> free_slots;
+            // The latest change tick in each chunk of change_chunk_size components, so unchanged chunks can be skipped
+            // note: only ever raised, so a chunk's tick may be later than any of its current components' ticks
+            list<chunk_change_tick> changed_chunk_ticks;
+            // The latest change tick of any component, ie. of any chunk
+            chunk_change_tick latest_changed_tick;
+            // Events sent as components are added to and removed from entities of the world
+            component_events events;
+        };
+
+        protected: // static methods
+        // Get this component type's state in a given world
+        static type_state& get_state( world& target_world )
+        {
+            return target_world.get_component_storage<type_state>( get_type_index() );
+        }
+        // Get this component type's state in the world that's current on the calling thread
+        static type_state& get_state()
+        {
+            return get_state( world::get_current() );
+        }
+
+        /* -------------------------------------------------------------------------- */
+        /*                            Component References                            */
+        /* -------------------------------------------------------------------------- */
+        public:
+        // A handle to a component of type T owned by another entity
+        // note: stores a slot index and generation rather than a component index, so it stays valid as components
+        //       move around the list without being notified, and resolves in O( 1 ) through the slot table
+        class reference : public component<reference>
+        {
+            public: // methods
+            reference( const T* target_pointer )
+            {
+                set_target( target_pointer );
+            }
+            reference( const entity* target_owner_pointer )
+            {
+                set_target_from_owner( target_owner_pointer );
+            }
+            reference( const reference& other ) : target_world( other.target_world ), target_slot( other.target_slot ), target_generation( other.target_generation ) {}
+            ~reference() {}
+
+            void set_target( const T* target_pointer )
+            {
+                set_target_from_owner( &target_pointer->get_owner() );
+            }
+            void set_target_from_owner( const entity* target_owner_pointer )
+            {
+                target_world      = &target_owner_pointer->get_world();
+                target_slot       = invalid_index;
+                target_generation = 0;
+
+                let_mutable& target_state = component<T, mode>::get_state( *target_world );
+                let* owned                = component<T, mode>::get_owned_component( target_state, target_owner_pointer->get_id() );
+                check_error_condition( return, ecs_log_errors, owned == nullptr, "Can't reference component '\1' of an entity that doesn't own one (\2)", reflection::get_type_name<T>(), target_owner_pointer->get_id() );
+
+                target_slot       = owned->get_slot_index();
+                target_generation = target_state.slots[target_slot].generation;
+            }
+
+            public: // accessors
+            // Get the referenced component, or nullptr if it has been destroyed
+            const T* get_pointer() const
+            {
+                let_mutable& target_state = component<T, mode>::get_state( *target_world );
+                let index                 = component<T, mode>::resolve_slot( target_state, target_slot, target_generation );
+                return index == invalid_index ? nullptr : &( target_state.components[index].component_data );
+            }
+            const entity& get_referenced_owner() const
+            {
+                // note: see get_owner
+                const static entity invalid_owner{ world::get_default() };
+                let* target_pointer = get_pointer();
+                check_error_condition( return invalid_owner, ecs_log_errors, target_pointer == nullptr, "Referenced component '\1' has been destroyed", reflection::get_type_name<T>() );
+
+                return target_pointer->get_owner();
+            }
+
+            // Check that the referenced component still exists
+            inline let is_valid get_value( get_pointer() != nullptr );
+
+            private: // members
+            // note: the referenced component's slot is only meaningful in the world of its owner
+            world* target_world;
+            usize target_slot;
+            uint target_generation;
 
             public: // constants
             static const usize invalid_index = ~0;
@@ -597,16 +1677,9 @@ namespace rnjin::ecs
 
     // static member definitions
     // clang-format off
-    template <typename T> typename component<T>::component_events component<T>::events;
-    template <typename T> list<typename component<T>::owned_component> component<T>::components;
-    template <typename T> set<typename entity::id> component<T>::owners;
-    template <typename T> event<usize> component<T>::reallocating_component_added_event { "reallocating component added" };
-    template <typename T> event<usize> component<T>::reallocating_component_removed_event { "reallocating component removed" };
-
-    template <typename T> bool component<T>::reference::handlers_initialized = false;
-    template <typename T> static_event_handler<usize> component<T>::reference::component_added_handler;
-    template <typename T> static_event_handler<usize> component<T>::reference::component_removed_handler;
+    template <typename T, storage_mode mode> typename component<T, mode>::current_world_events component<T, mode>::events;
     // clang-format on 
 
 #define component_class( name ) class name : public rnjin::ecs::component<name>
+#define component_class_with_storage( name, mode ) class name : public rnjin::ecs::component<name, rnjin::ecs::storage_mode::mode>
 } // namespace rnjin::ecs
\ No newline at end of file
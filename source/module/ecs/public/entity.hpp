@@ -7,6 +7,8 @@
 #pragma once
 #include <rnjin.hpp>
 
+#include "signature.hpp"
+
 #include "core/module.h"
 #include "log/module.h"
 
@@ -29,26 +31,93 @@ namespace rnjin::ecs
     extern log::source::masked ecs_log_errors;
 
     class component_type_handle_base;
+    class command_buffer;
+    class entity_batch;
+    class world;
+
+    // Identifies an entity by a dense index, which is reused once the entity is destroyed, and the generation of that
+    // index, which changes each time it is reused
+    // note: the index is what's used as a key into per-entity tables (sparse sets, signatures), so they stay as small
+    //       as the number of entities alive at once rather than growing with every entity ever created
+    // note: index 0 is never given to an entity, so a default-constructed id is invalid
+    class entity_id
+    {
+        public: // types
+        using value_type = uint;
+
+        public: // methods
+        entity_id() : index( 0 ), generation( 0 ) {}
+        entity_id( const value_type index, const value_type generation ) : pass_member( index ), pass_member( generation ) {}
+
+        // Compare two IDs
+        // note: ordered by index, then generation, so IDs sharing a recycled index still have a strict order (live entities
+        //       never share an index, so per-entity lists stay sorted by index)
+        inline bool operator==( const entity_id& other ) const
+        {
+            return index == other.index and generation == other.generation;
+        }
+        inline bool operator!=( const entity_id& other ) const
+        {
+            return not( *this == other );
+        }
+        inline bool operator<( const entity_id& other ) const
+        {
+            return index < other.index or ( index == other.index and generation < other.generation );
+        }
+        inline bool operator>( const entity_id& other ) const
+        {
+            return other < *this;
+        }
+        inline bool operator<=( const entity_id& other ) const
+        {
+            return not( other < *this );
+        }
+        inline bool operator>=( const entity_id& other ) const
+        {
+            return not( *this < other );
+        }
+
+        public: // accessors
+        inline let value get_value( index );
+        inline let get_generation get_value( generation );
+        inline let is_valid get_value( index != 0 );
+
+        public: // static methods
+        static entity_id invalid()
+        {
+            return entity_id();
+        }
+
+        private: // members
+        value_type index;
+        value_type generation;
+    };
+
+    std::ostream& operator<<( std::ostream& stream, const entity_id& id );
 
     class entity
     {
         no_copy( entity );
 
         public: // types
-        using id = unique_id<entity>;
+        using id = ecs::entity_id;
 
         public: // methods
+        // Create an entity in the world that's current on this thread
         entity();
+        // Create an entity in a given world
+        explicit entity( world& owner_world );
         ~entity();
 
         // Add a component to this entity
-        // note: actually forwards call to component::add_to, since
+        // note: actually forwards call to component::add_to (through the component type, so
+        //       its storage mode is respected), since
         //       entities don't internally store their associated components
         template <typename component_type, typename... arg_types>
         void add( arg_types... args )
         {
-            component<component_type>::add_to( *this, args... );
-            add_component_type_handle( component<component_type>::get_type_handle_pointer() );
+            component_type::add_to( *this, args... );
+            add_component_type_handle( component_type::get_type_handle_pointer() );
         }
 
         // Add a component to this entity if it doesn't already exist
@@ -57,8 +126,8 @@ namespace rnjin::ecs
         template <typename component_type, typename... arg_types>
         void require( arg_types... args )
         {
-            component<component_type>::add_unique( *this, args... );
-            add_component_type_handle( component<component_type>::get_type_handle_pointer() );
+            component_type::add_unique( *this, args... );
+            add_component_type_handle( component_type::get_type_handle_pointer() );
         }
 
         // Remove a component from this entity
@@ -67,8 +136,16 @@ namespace rnjin::ecs
         template <typename component_type>
         void remove()
         {
-            component<component_type>::remove_from( *this );
-            remove_component_type_handle( component<component_type>::get_type_handle_pointer() );
+            component_type::remove_from( *this );
+            remove_component_type_handle( component_type::get_type_handle_pointer() );
+        }
+
+        // Check if this entity owns a component of a given type
+        // note: a single bit test on the entity's signature
+        template <typename component_type>
+        bool has() const
+        {
+            return get_signature().has( component_type::get_type_index() );
         }
 
         // Get a component attached to this entity
@@ -77,7 +154,7 @@ namespace rnjin::ecs
         template <typename component_type>
         const component_type* get() const
         {
-            return component<component_type>::owned_by( *this );
+            return component_type::owned_by( *this );
         }
 
         // Get a component attached to this entity as a mutable pointer
@@ -86,7 +163,7 @@ namespace rnjin::ecs
         template <typename component_type>
         component_type* get_mutable() const
         {
-            return component<component_type>::owned_by( *this );
+            return component_type::owned_by( *this );
         }
 
         inline bool operator==( const entity& other ) const
@@ -95,6 +172,9 @@ namespace rnjin::ecs
         }
 
         private: // methods
+        friend class command_buffer;
+        friend class entity_batch;
+
         void add_component_type_handle( const component_type_handle_base* type_handle_pointer );
         void remove_component_type_handle( const component_type_handle_base* type_handle_pointer );
 
@@ -102,10 +182,33 @@ namespace rnjin::ecs
         let get_id get_value( entity_id );
         let is_being_destroyed get_value( destroying );
 
+        // Get the world this entity (and all of its components) belongs to
+        world& get_world() const
+        {
+            return *owner_world;
+        }
+
+        // Get the set of component types this entity owns
+        const signature& get_signature() const;
+
+        public: // static methods
+        // Get the set of component types owned by the entity with a given id (empty for unknown ids)
+        // note: used by systems to check their filters against an entity without looking up its components
+        // note: only meaningful for live entities, since a destroyed entity's index may belong to a new one
+        // note: ids are looked up in the world that's current on this thread
+        static const signature& get_signature( const id entity_id );
+
+        // Check that an id belongs to an entity that hasn't been destroyed
+        // note: ids of destroyed entities stay detectably stale after their index is reused, as the generation differs
+        // note: ids are looked up in the world that's current on this thread
+        static bool is_alive( const id entity_id );
+
         private: // members
+        // note: the component types an entity owns are kept in its world's table of signatures indexed by id value
+        //       (see world::get_signature), rather than on the entity, so systems can check them from an id alone
+        world* owner_world;
         id entity_id;
         bool destroying;
-        set<const component_type_handle_base*> owned_component_types;
 
         // public: // static
         // static group
@@ -126,4 +229,13 @@ namespace rnjin::ecs
         // }
         // events;
     };
-} // namespace rnjin::ecs
\ No newline at end of file
+} // namespace rnjin::ecs
+
+template <>
+struct std::hash<rnjin::ecs::entity_id>
+{
+    inline size_t operator()( const rnjin::ecs::entity_id& id ) const
+    {
+        return std::hash<uint64_t>()( ( uint64_t( id.get_generation() ) << 32 ) | id.value() );
+    }
+};
\ No newline at end of file
@@ -0,0 +1,92 @@
+/* *** ** *** ** *** ** *** *
+ * Part of rnjin            *
+ * (c) Rajin Shankar, 2019  *
+ *        rajinshankar.com  *
+ * *** ** *** ** *** ** *** */
+
+#pragma once
+#include <rnjin.hpp>
+
+#include <memory>
+
+#include "entity.hpp"
+#include "component.hpp"
+#include "world.hpp"
+
+#include "core/module.h"
+#include "reflection/module.h"
+
+namespace rnjin::ecs
+{
+    // A group of entities created and destroyed together, with components added to all of them at once
+    // ex. `entity_batch particles( 50000 ); particles.add<position>( 0.0f, 0.0f );`
+    //     `particles.add_each<velocity>( []( usize i ) { return velocity( i ); } );`
+    // note: each component type is added with a single reservation and merge of its component list (see
+    //       component::add_to_all), rather than a search and insert per entity
+    // note: destroying the batch removes each component type added through it from all entities at once, before the
+    //       entities themselves are destroyed
+    class entity_batch
+    {
+        public: // methods
+        // Create entities in the world that's current on this thread
+        entity_batch( const usize count );
+        // Create entities in a given world
+        entity_batch( const usize count, world& owner_world );
+        ~entity_batch();
+        no_copy( entity_batch );
+
+        // Add a component to every entity in the batch, constructed from the same arguments
+        template <typename component_type, typename... arg_types>
+        void add( arg_types... args )
+        {
+            component_type::add_to_all( owner_world, entity_pointers, [&]( list<typename component_type::owned_component>& target, const usize index ) {
+                target.emplace_back( *entity_pointers[index], args... );
+            } );
+            add_component_type_handle( component_type::get_type_handle_pointer() );
+        }
+
+        // Add a component to every entity in the batch, with an initial value for each
+        // note: initialize( index ) returns the component for the entity at that index
+        template <typename component_type, typename initializer_type>
+        void add_each( const initializer_type& initialize )
+        {
+            component_type::add_to_all( owner_world, entity_pointers, [&]( list<typename component_type::owned_component>& target, const usize index ) {
+                target.emplace_back( *entity_pointers[index], initialize( index ) );
+            } );
+            add_component_type_handle( component_type::get_type_handle_pointer() );
+        }
+
+        // Remove a component from every entity in the batch that owns one
+        template <typename component_type>
+        void remove()
+        {
+            component_type::remove_from_all( owner_world, entity_pointers );
+            remove_component_type_handle( component_type::get_type_handle_pointer() );
+        }
+
+        entity& operator[]( const usize index )
+        {
+            return entities[index];
+        }
+        const entity& operator[]( const usize index ) const
+        {
+            return entities[index];
+        }
+
+        public: // accessors
+        let get_count get_value( entity_pointers.size() );
+        let_mutable& get_world get_value( owner_world );
+
+        private: // methods
+        void add_component_type_handle( const component_type_handle_base* type_handle_pointer );
+        void remove_component_type_handle( const component_type_handle_base* type_handle_pointer );
+
+        private: // members
+        world& owner_world;
+        std::unique_ptr<entity[]> entities;
+        // Pointers to each entity, as expected by component::add_to_all / remove_from_all
+        list<entity*> entity_pointers;
+        // Component types added through the batch, removed from all entities at once when it is destroyed
+        list<const component_type_handle_base*> component_types;
+    };
+} // namespace rnjin::ecs
@@ -0,0 +1,299 @@
+/* *** ** *** ** *** ** *** *
+ * Part of rnjin            *
+ * (c) Rajin Shankar, 2019  *
+ *        rajinshankar.com  *
+ * *** ** *** ** *** ** *** */
+
+#pragma once
+#include <rnjin.hpp>
+
+#include <algorithm>
+#include <mutex>
+
+#include "entity.hpp"
+#include "component.hpp"
+#include "world.hpp"
+#include "system.hpp"
+
+#include "core/module.h"
+
+namespace rnjin::ecs
+{
+    // The kinds of things that can happen to components, which observers react to
+    enum class trigger_kind
+    {
+        added,
+        removed,
+        changed,
+    };
+
+    // Trigger that fires for entities a component of type T has been added to
+    // note: used in observer template specialization (observer<on_add<T>, ...>)
+    template <typename component_type>
+    struct on_add
+    {
+        using observed_type               = component_type;
+        static constexpr trigger_kind kind = trigger_kind::added;
+    };
+
+    // Trigger that fires for entities a component of type T has been removed from (including by destroying the entity)
+    // note: used in observer template specialization (observer<on_remove<T>, ...>)
+    template <typename component_type>
+    struct on_remove
+    {
+        using observed_type               = component_type;
+        static constexpr trigger_kind kind = trigger_kind::removed;
+    };
+
+    // Trigger that fires for entities whose component of type T has changed
+    // note: used in observer template specialization (observer<on_change<T>, ...>)
+    // note: changes are found from change ticks, like changed<T>, so components count as changed when they're added,
+    //       accessed through write_to<T>, or marked with mark_changed
+    template <typename component_type>
+    struct on_change
+    {
+        using observed_type               = component_type;
+        static constexpr trigger_kind kind = trigger_kind::changed;
+    };
+
+    // A system that reacts to components being added, removed or changed, by only visiting the entities affected since
+    // its last update
+    // ex. `class my_observer : public observer<on_add<my_component>, on_remove<my_component>> {...};`, then
+    //     `my_observer.update_all();` at a sync point (ex. once each frame, or from a scheduler)
+    // note: additions and removals are collected from component events as they happen, and changes are found at the
+    //       start of the next update from change ticks (skipping the whole list when nothing of the type has changed)
+    // note: each affected entity is visited once per update, in order of id, no matter how many triggers fired for it
+    //       or how many times (ex. a component added then removed again visits its owner once, for both triggers)
+    // note: when nothing has been affected, update_all returns without calling any update methods, so observers cost
+    //       next to nothing in frames where their components are left alone
+    // note: observed component types count as read by the observer for scheduling (see writes_to for others)
+    template <typename... trigger_types>
+    class observer : public system_base, public event_receiver
+    {
+        private: // types
+        // A set of triggers, one bit for each of this observer's triggers in order
+        using trigger_mask = uint;
+        static_assert( sizeof...( trigger_types ) > 0 and sizeof...( trigger_types ) <= 32, "Observers need between 1 and 32 triggers" );
+
+        public: // types
+        // An entity that one or more triggers fired for since the observer's last update
+        class observed_entity
+        {
+            public: // methods
+            observed_entity( const entity::id id, const trigger_mask triggers ) : pass_member( id ), pass_member( triggers ), owner( nullptr ) {}
+
+            // Check whether a trigger fired for this entity
+            // ex. `if ( affected.triggered_by<on_remove<my_component>>() ) {...}`
+            template <typename trigger_type>
+            bool triggered_by() const
+            {
+                return ( triggers & get_trigger_bit<trigger_type>() ) != 0;
+            }
+
+            public: // accessors
+            let get_id get_value( id );
+            // The entity itself, or nullptr if it has been destroyed since it was affected
+            let get_entity get_value( owner );
+
+            private: // members
+            friend observer;
+
+            entity::id id;
+            trigger_mask triggers;
+            entity* owner;
+        };
+
+        public: // methods
+        // Start collecting the entities affected in the world that's current on this thread
+        observer()
+        {
+            ( subscribe<trigger_types>(), ... );
+        }
+        virtual ~observer() {}
+
+        // Call `update` on each entity affected since the last update, or nothing at all if none were
+        void update_all() override
+        {
+            world_scope scope( target_world );
+            let update_tick = target_world.advance_change_tick();
+
+            // Take the entities collected from events, then find changed ones
+            affected_entities.clear();
+            subregion
+            {
+                std::lock_guard<std::mutex> lock( pending_lock );
+                affected_entities.swap( pending );
+            }
+            ( collect_changes<trigger_types>(), ... );
+
+            if ( affected_entities.empty() )
+            {
+                last_update_tick = update_tick;
+                return;
+            }
+
+            // Merge repeated entities, so each one is visited once with every trigger that fired for it
+            std::sort( affected_entities.begin(), affected_entities.end(), []( const observed_entity& a, const observed_entity& b ) { return a.id < b.id; } );
+            usize merged_count = 0;
+            for ( usize i = 0; i < affected_entities.size(); i++ )
+            {
+                if ( merged_count > 0 and affected_entities[merged_count - 1].id == affected_entities[i].id )
+                {
+                    affected_entities[merged_count - 1].triggers |= affected_entities[i].triggers;
+                }
+                else
+                {
+                    affected_entities[merged_count] = affected_entities[i];
+                    merged_count += 1;
+                }
+            }
+            affected_entities.erase( affected_entities.begin() + merged_count, affected_entities.end() );
+
+            before_update();
+            for ( observed_entity& each : affected_entities )
+            {
+                each.owner = target_world.get_entity( each.id );
+                update( each );
+            }
+            after_update();
+
+            last_update_tick = update_tick;
+        }
+
+        protected: // virtual methods
+        virtual void update( observed_entity& affected ) pure_virtual;
+
+        // note: only called in updates with at least one affected entity
+        virtual void before_update() {}
+        virtual void after_update() {}
+
+        protected: // methods
+        // Declare that this observer writes components of type T (ex. through entity::get_mutable in update), so
+        // schedulers don't update it alongside systems accessing them
+        // note: called from the derived observer's constructor
+        template <typename component_type>
+        void writes_to()
+        {
+            written_types.push_back( get_type_key<component_type>() );
+        }
+
+        protected: // accessors
+        // Number of entities visited by the current (or last) update
+        let get_affected_count get_value( affected_entities.size() );
+
+        private: // methods
+        // Get the bit of a trigger in trigger masks
+        template <typename trigger_type>
+        static constexpr trigger_mask get_trigger_bit()
+        {
+            trigger_mask bit    = 1;
+            trigger_mask result = 0;
+            ( ( result |= std::is_same_v<trigger_type, trigger_types> ? bit : 0, bit <<= 1 ), ... );
+            return result;
+        }
+
+        // Start collecting entities for a trigger
+        template <typename trigger_type>
+        void subscribe()
+        {
+            using component_type = typename trigger_type::observed_type;
+            read_types.push_back( get_type_key<component_type>() );
+
+            let_mutable& events = component_type::get_events( target_world );
+            if constexpr ( trigger_type::kind == trigger_kind::added )
+            {
+                handle_event( events.added_batch(), &observer::template on_added<trigger_type> );
+            }
+            else if constexpr ( trigger_type::kind == trigger_kind::removed )
+            {
+                handle_event( events.removed_batch(), &observer::template on_removed<trigger_type> );
+            }
+        }
+
+        // Event handlers
+        // note: components can be added and removed while other systems update on other threads (ex. a system applying
+        //       a command buffer), so collected entities are guarded by a lock
+        template <typename trigger_type>
+        void on_added( const typename trigger_type::observed_type::added_span& added )
+        {
+            std::lock_guard<std::mutex> lock( pending_lock );
+            foreach ( entry : added )
+            {
+                pending.emplace_back( entry.owner->get_id(), get_trigger_bit<trigger_type>() );
+            }
+        }
+        template <typename trigger_type>
+        void on_removed( const typename trigger_type::observed_type::removed_span& removed )
+        {
+            std::lock_guard<std::mutex> lock( pending_lock );
+            foreach ( entry : removed )
+            {
+                pending.emplace_back( entry.owner->get_id(), get_trigger_bit<trigger_type>() );
+            }
+        }
+
+        // Find the owners of components changed since the last update, for a trigger
+        // note: skips unchanged chunks of the list, and the whole list if no component of the type has changed
+        template <typename trigger_type>
+        void collect_changes()
+        {
+            using component_type = typename trigger_type::observed_type;
+            if constexpr ( trigger_type::kind == trigger_kind::changed )
+            {
+                if ( component_type::get_latest_changed_tick() <= last_update_tick )
+                {
+                    return;
+                }
+
+                let collect = [&]( const typename component_type::owned_component& owned ) {
+                    if ( owned.get_changed_tick() > last_update_tick )
+                    {
+                        affected_entities.emplace_back( owned.get_owner_id(), get_trigger_bit<trigger_type>() );
+                    }
+                };
+
+                constexpr usize chunk_size = component_type::change_chunk_size;
+                let count                  = component_type::get_owned_component_count();
+                for ( usize chunk_first = 0; chunk_first < count; chunk_first += chunk_size )
+                {
+                    if ( component_type::get_chunk_changed_tick( chunk_first / chunk_size ) <= last_update_tick )
+                    {
+                        continue;
+                    }
+
+                    let chunk_last = std::min( chunk_first + chunk_size, count );
+                    if constexpr ( component_type::storage == storage_mode::paged )
+                    {
+                        let& pages = component_type::get_owned_component_pages();
+                        for ( usize index = chunk_first; index < chunk_last; index++ )
+                        {
+                            if ( pages.is_occupied( index ) )
+                            {
+                                collect( pages[index] );
+                            }
+                        }
+                    }
+                    else
+                    {
+                        let* components = component_type::get_owned_components();
+                        for ( usize index = chunk_first; index < chunk_last; index++ )
+                        {
+                            collect( components[index] );
+                        }
+                    }
+                }
+            }
+        }
+
+        private: // members
+        // Entities collected from events since the last update
+        list<observed_entity> pending;
+        std::mutex pending_lock;
+
+        // Entities visited by the current (or last) update
+        list<observed_entity> affected_entities;
+
+        // The change tick this observer last updated at, so on_change<T> only finds components changed after it
+        change_tick last_update_tick = 0;
+    };
+} // namespace rnjin::ecs
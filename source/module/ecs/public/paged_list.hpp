@@ -0,0 +1,214 @@
+/* *** ** *** ** *** ** *** *
+ * Part of rnjin            *
+ * (c) Rajin Shankar, 2019  *
+ *        rajinshankar.com  *
+ * *** ** *** ** *** ** *** */
+
+#pragma once
+#include <rnjin.hpp>
+
+#include <memory>
+#include <new>
+#include <utility>
+
+#include "core/module.h"
+
+namespace rnjin::ecs
+{
+    // A list of elements kept in fixed-size pages, so an element stays at the same address from when it is added until it
+    // is removed
+    // note: removing an element leaves a vacancy at its index, which the next added element reuses, so indices (and
+    //       addresses) are never shifted, and growing only ever allocates a new page rather than moving existing elements
+    // note: pages are pooled by the list, ie. clearing it keeps every page for reuse, and they're only freed with the list
+    // note: used for components with storage_mode::paged
+    template <typename T, usize page_size>
+    class paged_list
+    {
+        private: // types
+        // Storage for page_size elements, and whether each of them is in use
+        struct page
+        {
+            page()
+            {
+                for ( usize i = 0; i < page_size; i++ )
+                {
+                    occupied[i] = false;
+                }
+            }
+
+            T* element_at( const usize offset )
+            {
+                return reinterpret_cast<T*>( storage ) + offset;
+            }
+
+            alignas( T ) byte storage[sizeof( T ) * page_size];
+            bool occupied[page_size];
+        };
+
+        public: // types
+        // A Rust-style iterator over the elements in use, skipping vacancies (see mutable_iterator in containers.hpp)
+        template <typename element_type, typename list_type>
+        class basic_iterator
+        {
+            public: // methods
+            inline basic_iterator( list_type& source ) : source( source ), index( 0 )
+            {
+                skip_vacancies();
+            }
+            inline basic_iterator& begin()
+            {
+                return *this;
+            }
+            inline basic_iterator& end()
+            {
+                return *this;
+            }
+            inline element_type& operator*()
+            {
+                return source[index];
+            }
+            inline const bool operator!=( const basic_iterator& other )
+            {
+                return is_valid();
+            }
+            inline basic_iterator& operator++()
+            {
+                advance();
+                return *this;
+            }
+
+            inline bool is_valid()
+            {
+                return index < source.size();
+            }
+            inline void advance()
+            {
+                index += 1;
+                skip_vacancies();
+            }
+
+            private: // methods
+            inline void skip_vacancies()
+            {
+                while ( index < source.size() and not source.is_occupied( index ) )
+                {
+                    index += 1;
+                }
+            }
+
+            private: // members
+            list_type& source;
+            usize index;
+        };
+        using mutable_iterator = basic_iterator<T, paged_list>;
+        using const_iterator   = basic_iterator<const T, const paged_list>;
+
+        public: // methods
+        paged_list() : count( 0 ), end_index( 0 ) {}
+        ~paged_list()
+        {
+            clear();
+        }
+        no_copy( paged_list );
+
+        // Construct a new element, reusing the index of a removed element first, and get its index
+        template <typename... arg_types>
+        usize emplace( arg_types&&... args )
+        {
+            usize index;
+            if ( not free_indices.empty() )
+            {
+                index = free_indices.back();
+                free_indices.pop_back();
+            }
+            else
+            {
+                index = end_index;
+                reserve( index + 1 );
+                end_index += 1;
+            }
+
+            let_mutable& target_page = *pages[index / page_size];
+            new ( target_page.element_at( index % page_size ) ) T( std::forward<arg_types>( args )... );
+            target_page.occupied[index % page_size] = true;
+            count += 1;
+            return index;
+        }
+
+        // Destroy the element at an index, leaving a vacancy for the next added element
+        void erase( const usize index )
+        {
+            let_mutable& target_page = *pages[index / page_size];
+            target_page.element_at( index % page_size )->~T();
+            target_page.occupied[index % page_size] = false;
+            count -= 1;
+
+            // Once every element is gone, new ones can start from the first index again
+            if ( count == 0 )
+            {
+                free_indices.clear();
+                end_index = 0;
+            }
+            else
+            {
+                free_indices.push_back( index );
+            }
+        }
+
+        // Destroy every element, keeping the pages for reuse
+        void clear()
+        {
+            for ( usize index = 0; index < end_index; index++ )
+            {
+                let_mutable& target_page = *pages[index / page_size];
+                if ( target_page.occupied[index % page_size] )
+                {
+                    target_page.element_at( index % page_size )->~T();
+                    target_page.occupied[index % page_size] = false;
+                }
+            }
+
+            free_indices.clear();
+            count     = 0;
+            end_index = 0;
+        }
+
+        // Allocate pages up front, so a total of new_count elements fit without allocating
+        void reserve( const usize new_count )
+        {
+            while ( pages.size() * page_size < new_count )
+            {
+                pages.emplace_back( new page() );
+            }
+        }
+
+        bool is_occupied( const usize index ) const
+        {
+            return index < end_index and pages[index / page_size]->occupied[index % page_size];
+        }
+
+        T& operator[]( const usize index )
+        {
+            return *pages[index / page_size]->element_at( index % page_size );
+        }
+        const T& operator[]( const usize index ) const
+        {
+            return *pages[index / page_size]->element_at( index % page_size );
+        }
+
+        public: // accessors
+        // Number of elements in use
+        let get_count get_value( count );
+        let empty get_value( count == 0 );
+        // One past the last index ever used since the list was last empty, ie. the range of indices to iterate over
+        // note: includes vacancies, see is_occupied
+        let size get_value( end_index );
+
+        private: // members
+        list<std::unique_ptr<page>> pages;
+        // Vacant indices below end_index, to be reused by new elements
+        list<usize> free_indices;
+        usize count;
+        usize end_index;
+    };
+} // namespace rnjin::ecs
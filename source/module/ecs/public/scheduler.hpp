@@ -0,0 +1,94 @@
+/* *** ** *** ** *** ** *** *
+ * Part of rnjin            *
+ * (c) Rajin Shankar, 2019  *
+ *        rajinshankar.com  *
+ * *** ** *** ** *** ** *** */
+
+#pragma once
+#include <rnjin.hpp>
+
+#include <condition_variable>
+#include <mutex>
+
+#include "system.hpp"
+
+#include "core/module.h"
+#include "worker/module.h"
+
+namespace rnjin::ecs
+{
+    // Updates a set of systems each frame, running systems that don't conflict at the same time on a worker pool
+    // ex. `frame.add( mesh_collect ); frame.add( material_collect ); frame.update_all();`
+    // note: a system updates after every system it depends_on, and after every earlier-added system it conflicts with
+    //       (ie one of them writes a component type the other reads or writes)
+    // note: systems must stay alive while they're part of a scheduler
+    class scheduler
+    {
+        public: // methods
+        scheduler( worker::pool& workers = worker::pool::get_default() );
+        ~scheduler();
+        no_copy( scheduler );
+
+        // Add a system to be updated each frame, and let it declare its dependencies
+        template <typename system_type>
+        void add( system_type& new_system )
+        {
+            add_system( new_system, get_type_key<system_type>() );
+        }
+
+        // Remove a system so it is no longer updated
+        void remove( system_base& old_system );
+
+        // Update all systems once, in dependency order
+        void update_all();
+
+        public: // accessors
+        let get_system_count get_value( nodes.size() );
+
+        // Time taken by the last frame, in seconds
+        let get_frame_time get_value( frame_time );
+
+        // Time taken by the slowest chain of dependent systems in the last frame, in seconds
+        // note: frames can't take less time than this, no matter how many threads are available
+        let get_critical_path_time get_value( critical_path_time );
+
+        private: // types
+        struct node
+        {
+            system_base* system;
+            type_key system_type;
+
+            // Indices of nodes that update after this one, and the number of nodes this one updates after
+            list<usize> dependents;
+            usize dependency_count;
+
+            // State for the current frame
+            usize remaining_dependency_count;
+            double update_time;
+        };
+
+        private: // methods
+        void add_system( system_base& new_system, const type_key system_type );
+        void build_graph();
+        void add_edge( const usize from, const usize to );
+        bool conflicts( const usize first, const usize second ) const;
+        void run_ready_systems();
+        void update_critical_path_time();
+
+        private: // members
+        worker::pool& workers;
+
+        list<node> nodes;
+        list<usize> update_order;
+        bool graph_is_built;
+
+        // Frame state, shared by all threads running systems
+        std::mutex frame_lock;
+        std::condition_variable systems_ready;
+        list<usize> ready_nodes;
+        usize finished_count;
+
+        double frame_time;
+        double critical_path_time;
+    };
+} // namespace rnjin::ecs
@@ -0,0 +1,135 @@
+/* *** ** *** ** *** ** *** *
+ * Part of rnjin            *
+ * (c) Rajin Shankar, 2019  *
+ *        rajinshankar.com  *
+ * *** ** *** ** *** ** *** */
+
+#pragma once
+#include <rnjin.hpp>
+
+#include "core/module.h"
+
+namespace rnjin::ecs
+{
+    // Dense index identifying a component type, assigned the first time the type is used
+    // note: used as a bit index into signatures
+    using component_type_index = usize;
+
+    // Maximum number of component types that can be used in one program
+    static constexpr usize max_component_types = 128;
+
+    class component_type_handle_base;
+
+    // Get an unused component type index, and remember the handle for the component type it's given to
+    // note: called once per component type (see component_type_handle_base)
+    // note: aborts if every index is already taken
+    component_type_index register_component_type( const component_type_handle_base* type_handle_pointer, const string& type_name );
+
+    // Get the handle of the component type with a given index
+    // note: used by entities to notify each component type they own when they're destroyed
+    const component_type_handle_base* get_component_type_handle( const component_type_index index );
+
+    // A fixed-width set of component types, with one bit per component type index
+    // note: used to record which component types each entity owns, so systems can check all of their filters
+    //       against an entity with a few word-wide ANDs instead of looking up each component type
+    class signature
+    {
+        public: // methods
+        signature() : words{} {}
+
+        void set( const component_type_index index )
+        {
+            words[index / word_bits] |= word( 1 ) << ( index % word_bits );
+        }
+        void reset( const component_type_index index )
+        {
+            words[index / word_bits] &= ~( word( 1 ) << ( index % word_bits ) );
+        }
+        void clear()
+        {
+            for ( usize i = 0; i < word_count; i++ )
+            {
+                words[i] = 0;
+            }
+        }
+
+        // Check if a single component type is in the set
+        bool has( const component_type_index index ) const
+        {
+            return ( words[index / word_bits] >> ( index % word_bits ) ) & 1;
+        }
+
+        // Check if every component type in another signature is also in this one
+        bool contains( const signature& other ) const
+        {
+            for ( usize i = 0; i < word_count; i++ )
+            {
+                if ( ( words[i] & other.words[i] ) != other.words[i] )
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Check if any component type in another signature is also in this one
+        bool intersects( const signature& other ) const
+        {
+            for ( usize i = 0; i < word_count; i++ )
+            {
+                if ( ( words[i] & other.words[i] ) != 0 )
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Call `function( index )` for each component type in the set, in order of index
+        template <typename function_type>
+        void for_each( const function_type& function ) const
+        {
+            for ( usize i = 0; i < word_count; i++ )
+            {
+                word remaining = words[i];
+                for ( usize bit = 0; remaining != 0; bit++, remaining >>= 1 )
+                {
+                    if ( remaining & 1 )
+                    {
+                        function( i * word_bits + bit );
+                    }
+                }
+            }
+        }
+
+        // Get the number of component types in the set
+        usize count() const
+        {
+            usize result = 0;
+            for_each( [&result]( const component_type_index ) { result += 1; } );
+            return result;
+        }
+
+        bool is_empty() const
+        {
+            for ( usize i = 0; i < word_count; i++ )
+            {
+                if ( words[i] != 0 )
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        private: // types
+        using word = uint64;
+
+        private: // constants
+        static constexpr usize word_bits  = 64;
+        static constexpr usize word_count = ( max_component_types + word_bits - 1 ) / word_bits;
+
+        private: // members
+        word words[word_count];
+    };
+} // namespace rnjin::ecs
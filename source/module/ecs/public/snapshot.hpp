@@ -0,0 +1,78 @@
+/* *** ** *** ** *** ** *** *
+ * Part of rnjin            *
+ * (c) Rajin Shankar, 2019  *
+ *        rajinshankar.com  *
+ * *** ** *** ** *** ** *** */
+
+#pragma once
+#include <rnjin.hpp>
+
+#include "entity.hpp"
+#include "component.hpp"
+#include "world.hpp"
+
+#include "core/module.h"
+#include "file/module.h"
+#include "reflection/module.h"
+
+namespace rnjin::ecs
+{
+    // Writes the components of a fixed set of component types to a file, and restores them from it later, with one bulk
+    // write / read of owner ids and one of component bytes per type
+    // ex. `snapshot<position, velocity>::write( checkpoint );` ... `snapshot<position, velocity>::read( checkpoint );`
+    // note: component types must be trivially copyable, since their bytes are written as they are in memory, so a
+    //       snapshot can only be read by the same build it was written by
+    // note: reading replaces every component of each type without sending added / removed events (see component::restore),
+    //       but entities are owned by whoever created them, so only components of entities that still exist are restored
+    template <typename... component_types>
+    class snapshot
+    {
+        public: // static methods
+        // Write every component of each type in a world
+        static void write( io::file& target, world& source_world = world::get_current() )
+        {
+            target.write_var( uint( sizeof...( component_types ) ) );
+            ( write_components<component_types>( target, source_world ), ... );
+        }
+
+        // Replace every component of each type in a world with the ones in a snapshot
+        // note: stops at the first type that doesn't match the snapshot, leaving the types after it untouched
+        static void read( io::file& source, world& target_world = world::get_current() )
+        {
+            let type_count = source.read_var<uint>();
+            check_error_condition( return, ecs_log_errors, type_count != sizeof...( component_types ), "Can't read a snapshot of \1 component types as a snapshot of \2", type_count,
+                                          sizeof...( component_types ) );
+
+            ( read_components<component_types>( source, target_world ) and ... );
+        }
+
+        private: // static methods
+        template <typename T>
+        static void write_components( io::file& target, world& source_world )
+        {
+            list<entity::id> owner_ids;
+            list<component_bytes<T>> component_data;
+            T::capture( source_world, owner_ids, component_data );
+
+            // The type's name and size identify it when reading
+            target.write_string( reflection::get_type_name<T>() );
+            target.write_var( uint( sizeof( T ) ) );
+            target.write_buffer( owner_ids );
+            target.write_buffer( component_data );
+        }
+
+        template <typename T>
+        static bool read_components( io::file& source, world& target_world )
+        {
+            let type_name = source.read_string();
+            let type_size = source.read_var<uint>();
+            check_error_condition( return false, ecs_log_errors, type_name != reflection::get_type_name<T>() or type_size != sizeof( T ),
+                                          "Snapshot holds components '\1' (\2 bytes) where '\3' (\4 bytes) were expected", type_name, type_size, reflection::get_type_name<T>(), sizeof( T ) );
+
+            let owner_ids      = source.read_buffer<entity::id>();
+            let component_data = source.read_buffer<component_bytes<T>>();
+            T::restore( target_world, owner_ids, component_data );
+            return true;
+        }
+    };
+} // namespace rnjin::ecs
@@ -7,10 +7,17 @@
 #pragma once
 #include <rnjin.hpp>
 
+#include <algorithm>
+#include <tuple>
+#include <utility>
+
 #include "entity.hpp"
 #include "component.hpp"
+#include "archetype.hpp"
+#include "world.hpp"
 
 #include "core/module.h"
+#include "worker/module.h"
 
 namespace rnjin::ecs
 {
@@ -19,25 +26,205 @@ namespace rnjin::ecs
     template <typename component_type>
     struct read_from
     {
+        using accessed_type                    = component_type;
+        using access_type                      = read_from;
+        static constexpr bool is_writable      = false;
+        static constexpr bool is_change_filter = false;
+        static constexpr bool is_filter        = false;
+        static constexpr bool is_fetched       = true;
+
         read_from( const component_type& source ) : pass_member( source ) {}
         const component_type& source;
     };
 
     // Wrapper type for mutable references to component data
     // note: used in system template specialization (system<write_to<T>, ...>)
+    // note: components accessed this way are marked as changed (see changed<T>)
     template <typename component_type>
     struct write_to
     {
+        using accessed_type                    = component_type;
+        using access_type                      = write_to;
+        static constexpr bool is_writable      = true;
+        static constexpr bool is_change_filter = false;
+        static constexpr bool is_filter        = false;
+        static constexpr bool is_fetched       = true;
+
         write_to( nonconst component_type& destination ) : pass_member( destination ) {}
         nonconst component_type& destination;
     };
 
-    // Base class to derive new systems from
-    // note: systems are defined on the set of components they work with, tagged
-    //       with read_from<T> or write_to<T> depending on how each component needs
-    //       to be accessed (ex. my_system : public system<read_from<my_component>, write_to<other_component>>)
+    // Wrapper type for constant references to component data, which only visits components changed since the system's last update
+    // note: used in system template specialization as the first accessor (system<changed<T>, ...>), and read with readable<T>
+    // note: components count as changed when they're added, accessed through write_to<T>, or marked with mark_changed,
+    //       and unchanged chunks of components are skipped entirely, so updates cost O( changes ) rather than O( entities )
+    template <typename component_type>
+    struct changed : read_from<component_type>
+    {
+        using access_type                      = read_from<component_type>;
+        static constexpr bool is_change_filter = true;
+
+        changed( const component_type& source ) : read_from<component_type>( source ) {}
+    };
+
+    // Filter that only visits entities owning a component of type T, without accessing it
+    // note: used in system template specialization after the first accessor (system<read_from<A>, with<B>>)
+    // note: filters are checked against each entity's signature (see entity::get_signature) before any components
+    //       are looked up, so they cost a few word-wide ANDs per entity rather than a walk over T's list
+    template <typename component_type>
+    struct with
+    {
+        using accessed_type                    = component_type;
+        using access_type                      = with;
+        static constexpr bool is_writable      = false;
+        static constexpr bool is_change_filter = false;
+        static constexpr bool is_filter        = true;
+        static constexpr bool is_fetched       = false;
+
+        with( const component_type* ) {}
+    };
+
+    // Filter that only visits entities that don't own a component of type T
+    // note: used in system template specialization after the first accessor (system<read_from<A>, without<B>>)
+    template <typename component_type>
+    struct without
+    {
+        using accessed_type                    = component_type;
+        using access_type                      = without;
+        static constexpr bool is_writable      = false;
+        static constexpr bool is_change_filter = false;
+        static constexpr bool is_filter        = true;
+        static constexpr bool is_fetched       = false;
+
+        without( const component_type* ) {}
+    };
+
+    // Wrapper type for a constant pointer to component data that an entity may not own (nullptr if it doesn't)
+    // note: used in system template specialization after the first accessor (system<read_from<A>, optional<B>>),
+    //       and read with optional<T>
+    template <typename component_type>
+    struct optional
+    {
+        using accessed_type                    = component_type;
+        using access_type                      = optional;
+        static constexpr bool is_writable      = false;
+        static constexpr bool is_change_filter = false;
+        static constexpr bool is_filter        = true;
+        static constexpr bool is_fetched       = true;
+
+        optional( const component_type* source ) : pass_member( source ) {}
+        const component_type* source;
+    };
+
+    // A view of consecutive components of type T (or const T) in their component type's list
+    // ex. `let positions = chunk.writable<position>(); for ( usize i = 0; i < positions.size(); i++ ) { positions[i].x += 1; }`
+    // note: components are stored next to their owner ids and bookkeeping, so elements are a fixed stride apart rather
+    //       than tightly packed, but loops over a span make no calls per entity, so the compiler can unroll and vectorize them
+    template <typename T>
+    class component_span
+    {
+        private: // types
+        using owned_component = typename std::remove_const_t<T>::owned_component;
+
+        public: // methods
+        component_span( owned_component* first, const usize count ) : pass_member( first ), pass_member( count ) {}
+
+        T& operator[]( const usize index ) const
+        {
+            return first[index].component_data;
+        }
+
+        public: // accessors
+        let size get_value( count );
+
+        private: // members
+        owned_component* first;
+        usize count;
+    };
+
+    // Scratch space with one value per batch, for systems that accumulate results while updating in parallel
+    // ex. `batch_scratch<float> totals;` can be reset in before_update with get_batch_count(), written to in update with
+    //     `totals[components.get_batch_index()]`, then combined in after_update
+    // note: batches depend only on the batch size (not the number of threads), so combining values in batch order is deterministic
+    // note: values are padded to separate cache lines so batches on different threads don't contend for them
+    template <typename T>
+    class batch_scratch
+    {
+        private: // types
+        struct alignas( 64 ) padded_value
+        {
+            T value;
+        };
+
+        public: // methods
+        // Replace all values with one initial value per batch
+        void reset( const usize batch_count, const T& initial_value = T() )
+        {
+            values.assign( batch_count, padded_value{ initial_value } );
+        }
+
+        nonconst T& operator[]( const usize batch_index )
+        {
+            return values[batch_index].value;
+        }
+        const T& operator[]( const usize batch_index ) const
+        {
+            return values[batch_index].value;
+        }
+
+        public: // accessors
+        let get_batch_count get_value( values.size() );
+
+        private: // members
+        list<padded_value> values;
+    };
+
+    // Base type of all systems, so they can be scheduled without knowing their exact type
+    // note: a system updates the world that's current on the thread it's created on (see world_scope)
+    class system_base
+    {
+        public: // methods
+        system_base() : target_world( world::get_current() ) {}
+        virtual ~system_base() {}
+
+        virtual void update_all() pure_virtual;
+
+        public: // accessors
+        let& get_read_types get_value( read_types );
+        let& get_written_types get_value( written_types );
+        let& get_dependencies get_value( dependencies );
+        let_mutable& get_world get_value( target_world );
+
+        protected: // virtual methods
+        // Declare dependencies on other systems (with depends_on)
+        // note: called by a scheduler when the system is added to it
+        virtual void define() pure_virtual;
+
+        protected: // methods
+        // Declare that this system must update after all systems of type system_type in the same scheduler
+        template <typename system_type>
+        void depends_on()
+        {
+            dependencies.push_back( get_type_key<system_type>() );
+        }
+
+        protected: // members
+        friend class scheduler;
+
+        world& target_world;
+        list<type_key> read_types;
+        list<type_key> written_types;
+        list<type_key> dependencies;
+    };
+
     template <typename... accessor_types>
-    class system
+    class system;
+
+    // Iteration shared by system<...> (whose update methods are virtual) and static_system<...> (whose update methods are
+    // called directly on the derived type, so they can be inlined into the loops below)
+    // note: derived_type is void for system<...>
+    template <typename derived_type, typename... accessor_types>
+    class basic_system : public system_base
     {
         protected: // types
         // A grouping of associated components this system operates on, accessible through access types (read_to, write_from)
@@ -45,14 +232,14 @@ namespace rnjin::ecs
         class entity_components
         {
             public: // methods
-            entity_components( accessor_types... accessors ) : accessors( accessors... ) {}
+            entity_components( accessor_types... accessors ) : accessors( accessors... ), batch_index( 0 ) {}
 
             // Get a constant reference to the collection member of type T
-            // note: will fail type checking if the system is not defined on read_from<T>
+            // note: will fail type checking if the system is not defined on read_from<T> or changed<T>
             template <typename T>
             const T& readable()
             {
-                let& accessor = std::get<get_tuple_index_by_type<read_from<T>, 0, accessor_types...>::index>( accessors );
+                let& accessor = std::get<get_tuple_index_by_type<read_from<T>, 0, typename accessor_types::access_type...>::index>( accessors );
                 return accessor.source;
             }
 
@@ -61,193 +248,491 @@ namespace rnjin::ecs
             template <typename T>
             nonconst T& writable()
             {
-                let& accessor = std::get<get_tuple_index_by_type<write_to<T>, 0, accessor_types...>::index>( accessors );
+                let& accessor = std::get<get_tuple_index_by_type<write_to<T>, 0, typename accessor_types::access_type...>::index>( accessors );
                 return accessor.destination;
             }
 
+            // Get a constant pointer to the collection member of type T, or nullptr if the entity doesn't own one
+            // note: will fail type checking if the system is not defined on optional<T>
+            template <typename T>
+            const T* optional()
+            {
+                let& accessor = std::get<get_tuple_index_by_type<ecs::optional<T>, 0, typename accessor_types::access_type...>::index>( accessors );
+                return accessor.source;
+            }
+
+            public: // accessors
+            // Index of the batch these components are being updated in (always 0 outside of update_all_parallel)
+            let get_batch_index get_value( batch_index );
+
             private: // members
-            std::tuple<accessor_types...> accessors;
+            friend basic_system;
 
-            private: // helpers for coercing compile-time data using the type system
-            // Error case of finding an index of a tuple by type
-            //      Should return an index that is out of bounds
-            template <typename T_search, usize N, typename... Ts>
-            struct get_tuple_index_by_type
-            {
-                static constexpr usize index = N;
-            };
-            // Terminal case of finding an index of a tuple by type
-            //      value is the number of steps it took to get here
-            template <typename T_search, usize N, typename... T_rest>
-            struct get_tuple_index_by_type<T_search, N, T_search, T_rest...>
+            std::tuple<typename accessor_types::access_type...> accessors;
+            usize batch_index;
+        };
+
+        // A run of consecutive entities whose components are at the same indices of each component type's list, as
+        // spans that can be looped over directly (ex. in an archetype's packed range)
+        // note: accessible through readable / writable like entity_components, but for the whole run at once
+        class chunk_components
+        {
+            public: // methods
+            chunk_components( const usize count, const usize batch_index, typename accessor_types::accessed_type::owned_component*... firsts )
+              : pass_member( count ),        //
+                pass_member( batch_index ),  //
+                firsts( firsts... )          //
+            {}
+
+            // Get constant references to the chunk's components of type T
+            // note: will fail type checking if the system is not defined on read_from<T> or changed<T>
+            template <typename T>
+            component_span<const T> readable() const
             {
-                static constexpr usize index = N;
-            };
-            // Non-terminal case of finding an index of a tuple by type
-            //      Continue search in rest of types
-            template <typename T_search, usize N, typename T_first, typename... T_rest>
-            struct get_tuple_index_by_type<T_search, N, T_first, T_rest...>
+                return component_span<const T>( std::get<get_tuple_index_by_type<read_from<T>, 0, typename accessor_types::access_type...>::index>( firsts ), count );
+            }
+
+            // Get mutable references to the chunk's components of type T
+            // note: will fail type checking if the system is not defined on write_to<T>
+            // note: every component in the chunk is marked as changed, whether or not it's written to
+            template <typename T>
+            component_span<T> writable() const
             {
-                static constexpr usize index = get_tuple_index_by_type<T_search, N + 1, T_rest...>::index;
-            };
-        };
+                return component_span<T>( std::get<get_tuple_index_by_type<write_to<T>, 0, typename accessor_types::access_type...>::index>( firsts ), count );
+            }
 
-        protected: // virtual methods
-        virtual void define() pure_virtual;
+            public: // accessors
+            // Number of entities in the chunk
+            let get_count get_value( count );
+            // Index of the batch the chunk is being updated in (always 0 outside of update_all_parallel)
+            let get_batch_index get_value( batch_index );
 
-        virtual void update( entity_components& components ) pure_virtual;
-        
-        virtual void before_update() {}
-        virtual void after_update() {}
+            private: // members
+            friend basic_system;
+
+            const usize count;
+            const usize batch_index;
+            std::tuple<typename accessor_types::accessed_type::owned_component*...> firsts;
+        };
 
         protected: // methods
-        template <typename system_type>
-        void depends_on()
+        // Number of batches in the current update (always 1 outside of update_all_parallel)
+        // note: set before before_update is called, so it can be used to size per-batch scratch space
+        let get_batch_count get_value( batch_count );
+
+        public:
+        // Record which component types are read and written, so schedulers can find conflicting systems
+        // note: with<T> and without<T> never touch component data, so they don't conflict with anything
+        basic_system()
         {
-            // TODO: Handle dependency graph generation between systems that rely on the output of other systems
+            ( record_access<accessor_types>(), ... );
         }
 
-        public:
         // Call `update` method on all groupings of entity-owned components that this system operates on
-        void update_all()
+        void update_all() override
         {
-            before_update();
+            world_scope scope( target_world );
+            let update_tick = target_world.advance_change_tick();
 
-            entity_iterator<accessor_types...> all;
-            while ( all.has_next() )
+            batch_count = 1;
+            call_before_update();
+
+            // Systems filtering on changes walk the changed chunks of the first component type's list
+            let chunked_count = get_chunked_count();
+            if constexpr ( first_accessor_type::is_change_filter )
+            {
+                update_looked_up_range( 0, first_component_type::get_owned_component_count(), 0 );
+            }
+            // If components share indices across types (ex. in an archetype's packed range), update them in chunks directly
+            else if ( chunked_count != invalid_count )
+            {
+                for ( usize first = 0; first < chunked_count; first += archetype_base::chunk_size )
+                {
+                    update_chunk_range( first, std::min( first + archetype_base::chunk_size, chunked_count ), 0 );
+                }
+            }
+            // Otherwise, align the component types' lists by owner id
+            else
             {
-                update( all.get_next() );
+                top_level_iterator all;
+                while ( all.has_next() )
+                {
+                    entity_components components = all.get_next();
+                    call_update( components );
+                }
             }
 
-            after_update();
+            call_after_update();
+            last_update_tick = update_tick;
         }
 
-        private: // helpers
-        // Terminal case (no accessors left)
-        // note: could still have invalid template parameters (not read_from or write_to), but that
-        //       should already give an error elsewhere
-        template <typename... Ts>
-        struct entity_iterator
+        // Call `update` on all groupings of entity-owned components that this system operates on, split into
+        // batches of `batch_size` entities that are updated on the worker pool's threads
+        // note: before_update and after_update are called once each, on the calling thread
+        // note: `update` must only touch the components it's given (and per-batch scratch space), and components
+        //       must not be added or removed until this returns
+        // note: each entity is visited by exactly one batch, and each component type is accessed through exactly one
+        //       accessor, so writes from different batches never alias
+        void update_all_parallel( const usize batch_size = archetype_base::chunk_size, worker::pool& workers = worker::pool::get_default() )
         {
-            // If we've gotten here, all parent iterators have returned true
-            inline bool has( entity::id target )
+            static_assert( accessed_types_are_unique, "Systems can only update in parallel if each component type has a single accessor" );
+            check_error_condition( return, ecs_log_errors, batch_size == 0, "Can't update a system in batches of 0 entities" );
+            world_scope scope( target_world );
+            let update_tick = target_world.advance_change_tick();
+            prepare_states();
+
+            // Batches split the range of components that can be updated in chunks if there is one, otherwise the first component type's list
+            let chunked_count = get_chunked_count();
+            let total_count   = chunked_count != invalid_count ? chunked_count : first_component_type::get_owned_component_count();
+
+            batch_count = ( total_count + batch_size - 1 ) / batch_size;
+            call_before_update();
+
+            workers.run_all( batch_count, [&]( const usize batch_index ) {
+                world_scope batch_scope( target_world );
+                let first = batch_index * batch_size;
+                let last  = std::min( first + batch_size, total_count );
+
+                if ( chunked_count != invalid_count )
+                {
+                    update_chunk_range( first, last, batch_index );
+                }
+                else
+                {
+                    update_looked_up_range( first, last, batch_index );
+                }
+            } );
+
+            call_after_update();
+            last_update_tick = update_tick;
+        }
+
+        private: // methods
+        // Create the state of each accessed component type in this system's world up front
+        // note: batches on worker threads only look up existing state, since creating it isn't thread safe
+        static void prepare_states()
+        {
+            ( static_cast<void>( accessor_types::accessed_type::get_owned_component_count() ), ... );
+        }
+
+        template <typename accessor_type>
+        void record_access()
+        {
+            if constexpr ( accessor_type::is_fetched )
             {
-                return true;
+                ( accessor_type::is_writable ? written_types : read_types ).push_back( get_type_key<typename accessor_type::accessed_type>() );
             }
+        }
 
-            // All parent iterators have constructed parameters, so return the final structure
-            template <typename... Ts>
-            inline entity_components get_next_append( Ts... previous )
+        // Get the signatures an entity's signature must contain all of (required) and none of (excluded) to be visited
+        // note: every fetched component type except optional<T> is required, so entities missing one are rejected
+        //       before any of their components are looked up
+        static const signature& get_required_signature()
+        {
+            static const signature required = [] {
+                signature result;
+                ( ( not accessor_types::is_filter or std::is_same_v<accessor_types, with<typename accessor_types::accessed_type>> ? result.set( accessor_types::accessed_type::get_type_index() ) : void() ), ... );
+                return result;
+            }();
+            return required;
+        }
+        static const signature& get_excluded_signature()
+        {
+            static const signature excluded = [] {
+                signature result;
+                ( ( std::is_same_v<accessor_types, without<typename accessor_types::accessed_type>> ? result.set( accessor_types::accessed_type::get_type_index() ) : void() ), ... );
+                return result;
+            }();
+            return excluded;
+        }
+
+        // Check an entity's signature against this system's accessors
+        static bool matches_signature( const entity::id owner_id )
+        {
+            let& owned_types = entity::get_signature( owner_id );
+            return owned_types.contains( get_required_signature() ) and not owned_types.intersects( get_excluded_signature() );
+        }
+
+        // Get the archetype that packs all (and only) the component types this system operates on, if any
+        // note: systems filtering on changes never walk an archetype, since they only visit some of its entities,
+        //       and neither do systems with filters, which visit entities outside of it
+        static const archetype_base* get_matching_archetype()
+        {
+            if constexpr ( first_accessor_type::is_change_filter or filter_count > 0 )
             {
-                return entity_components( previous... );
+                return nullptr;
             }
-        };
 
-        template <typename T_first, typename... T_rest>
-        struct entity_iterator<read_from<T_first>, T_rest...>
-        {
-            entity_iterator() : component_iterator( T_first::get_const_iterator() ) {}
-            const_iterator<typename component<T_first>::owned_component> component_iterator;
+            const archetype_base* owning_archetypes[] = { accessor_types::accessed_type::get_owning_archetype()... };
+            const archetype_base* first_archetype     = owning_archetypes[0];
 
-            // Move all iterators along until they are all at the same ID.
-            // returns true if such an entry exists, false otherwise
-            // note: meant to only be called on the 'top-level' entity_iterator
-            inline bool has_next()
+            if ( first_archetype == nullptr or first_archetype->get_component_type_count() != sizeof...( accessor_types ) )
             {
-                // Keep going in this iterator until it's invalid
-                // TODO: short circuit if any other iterators become invalid
-                while ( component_iterator.is_valid() )
+                return nullptr;
+            }
+            foreach ( owning_archetype : owning_archetypes )
+            {
+                if ( owning_archetype != first_archetype )
                 {
-                    // Get the current entry for this component access iterator
-                    let next_id = ( *component_iterator ).get_owner_id();
+                    return nullptr;
+                }
+            }
 
-                    // Advance other iterators as needed until a match is found or we know one won't be found
-                    // (other iterator points to a higher ID, or is invalid)
-                    bool others_have_id = others.has( next_id );
+            return first_archetype;
+        }
 
-                    if ( others_have_id )
-                    {
-                        // All other iterators have the same ID, so leave state as-is and return true
-                        return true;
-                    }
-                    else
-                    {
-                        // Other iterators don't have this ID, so advance this one and try the next entry
-                        // TODO: advance this iterator to the max position of others' iterators, since nothing between will be shared
-                        component_iterator.advance();
-                    }
+        // Get the number of entities at the front of each component type's list whose components share indices, so they
+        // can be updated in chunks, or invalid_count if they don't
+        // note: that's an archetype's packed range, or the whole list for systems on a single component type
+        static usize get_chunked_count()
+        {
+            if constexpr ( not is_chunkable )
+            {
+                return invalid_count;
+            }
+            else if constexpr ( sizeof...( accessor_types ) == 1 )
+            {
+                return first_component_type::get_owned_component_count();
+            }
+            else
+            {
+                let* packed_archetype = get_matching_archetype();
+                return packed_archetype != nullptr ? packed_archetype->get_count() : invalid_count;
+            }
+        }
+
+        // Call `update_chunk` on a range of components known to share owners at each index
+        void update_chunk_range( const usize first, const usize last, const usize batch_index )
+        {
+            if constexpr ( is_chunkable )
+            {
+                chunk_components chunk( last - first, batch_index, access_range<accessor_types>( first, last )... );
+                call_update_chunk( chunk );
+            }
+        }
+
+        protected: // methods
+        // Call `update` on each entity in a chunk
+        // note: the default update_chunk of both kinds of systems
+        // note: only systems without filters are ever updated in chunks
+        template <usize... indices>
+        void update_chunk_entities( chunk_components& chunk, std::index_sequence<indices...> )
+        {
+            if constexpr ( is_chunkable )
+            {
+                for ( usize i = 0; i < chunk.count; i++ )
+                {
+                    entity_components components( accessor_types( std::get<indices>( chunk.firsts )[i].component_data )... );
+                    components.batch_index = chunk.batch_index;
+                    call_update( components );
                 }
+            }
+        }
 
-                // This iterator is invalid, so no other entries can exist as shared
-                return false;
+        private: // methods
+        // Call `update` on a range of the first component type's list, looking up other component types by owner
+        // note: unlike the top-level iterator, this can start anywhere in the list, so ranges can be updated independently
+        void update_looked_up_range( const usize first, const usize last, const usize batch_index )
+        {
+            if constexpr ( not first_accessor_type::is_change_filter )
+            {
+                update_looked_up_components( first, last, batch_index );
+                return;
             }
 
-            // Move all iterators forward until they match the target ID or we know they will never match
-            // (points to higher ID, or is invalid). Returns true if all iterators were able to align, false otherwise
-            // note: meant to only be called on 'child' associated_iterators, called from has_next of the 'top-level'
-            inline bool has( entity::id target )
+            // Skip chunks of the list that haven't changed since the last update
+            constexpr usize chunk_size = first_component_type::change_chunk_size;
+            for ( usize chunk_first = first; chunk_first < last; )
             {
-                while ( component_iterator.is_valid() )
+                let chunk_index = chunk_first / chunk_size;
+                let chunk_last  = std::min( ( chunk_index + 1 ) * chunk_size, last );
+                if ( first_component_type::get_chunk_changed_tick( chunk_index ) > last_update_tick )
                 {
-                    let next_id = ( *component_iterator ).get_owner_id();
+                    update_looked_up_components( chunk_first, chunk_last, batch_index );
+                }
+                chunk_first = chunk_last;
+            }
+        }
 
-                    if ( next_id == target )
-                    {
-                        // This iterator has aligned, so leave state as-is and check the next
-                        return others.has( target );
-                    }
-                    else if ( next_id > target )
+        void update_looked_up_components( const usize first, const usize last, const usize batch_index )
+        {
+            others_lookup_iterator others;
+            let update_owned = [&]( typename first_component_type::owned_component& owned ) {
+                if constexpr ( first_accessor_type::is_change_filter )
+                {
+                    if ( owned.get_changed_tick() <= last_update_tick )
                     {
-                        // This iterator has passed the target, so leave state as-is and report that no alignment is possible
-                        return false;
+                        return;
                     }
-                    else
+                }
+
+                if ( matches_signature( owned.get_owner_id() ) and others.has( owned.get_owner_id() ) )
+                {
+                    entity_components components = others.get_next_append( access<first_accessor_type>( &owned ) );
+                    components.batch_index       = batch_index;
+                    call_update( components );
+                }
+            };
+
+            // Pages aren't contiguous, and can have vacancies left by removed components
+            if constexpr ( first_component_type::storage == storage_mode::paged )
+            {
+                let_mutable& first_pages = first_component_type::get_owned_component_pages();
+                for ( usize i = first; i < last; i++ )
+                {
+                    if ( first_pages.is_occupied( i ) )
                     {
-                        // The target could still be found, so advance this iterator and repeat
-                        component_iterator.advance();
+                        update_owned( first_pages[i] );
                     }
                 }
+            }
+            else
+            {
+                let_mutable* first_components = first_component_type::get_owned_components();
+                for ( usize i = first; i < last; i++ )
+                {
+                    update_owned( first_components[i] );
+                }
+            }
+        }
 
-                // This iterator is invalid, so no alignment is possible
-                return false;
+        // Wrap a component for an accessor, marking it as changed if the accessor can write to it
+        // note: filters are given nullptr if the entity doesn't own a component (or it wasn't looked up)
+        template <typename accessor_type>
+        static accessor_type access( typename accessor_type::accessed_type::owned_component* owned )
+        {
+            if constexpr ( accessor_type::is_filter )
+            {
+                return accessor_type( owned == nullptr ? nullptr : &owned->component_data );
             }
+            else
+            {
+                if constexpr ( accessor_type::is_writable )
+                {
+                    accessor_type::accessed_type::mark_component_changed( *owned );
+                }
+                return accessor_type( owned->component_data );
+            }
+        }
 
-            // Go through each iterator and collect all current entries into an entity_components structure
-            // note: called on 'top-level' entity_iterator, calls get_next_append to aggregate references into final structure
-            inline entity_components get_next()
+        // Get the first of a range of components for an accessor, marking them all as changed if the accessor can write to them
+        template <typename accessor_type>
+        static typename accessor_type::accessed_type::owned_component* access_range( const usize first, const usize last )
+        {
+            if constexpr ( accessor_type::is_writable )
             {
-                entity_components result = others.get_next_append( read_from( ( *component_iterator ).component_data ) );
-                component_iterator.advance();
-                return result;
+                accessor_type::accessed_type::mark_components_changed( first, last );
             }
+            return accessor_type::accessed_type::get_owned_components() + first;
+        }
 
-            // Go through each remaining iterator and collect current entries into an entity_components structure
-            // note: called on 'child' entity_iterators from get_next in the 'top-level' one
-            template <typename... Ts>
-            inline entity_components get_next_append( Ts... previous )
+        private: // update method dispatch
+        // The type whose update methods are called: the derived type for static_system<...>, or system<...> itself
+        static constexpr bool is_static = not std::is_void_v<derived_type>;
+        using hooks_type                = std::conditional_t<is_static, derived_type, system<accessor_types...>>;
+
+        // Names the (protected) update methods of a type derived from this one as pointers to members, which only a type
+        // derived from it can do
+        // note: calls through the pointers are direct when the methods aren't virtual (ie static_system), so they can be inlined
+        template <typename target_type>
+        struct method_access : target_type
+        {
+            static constexpr auto update_method        = &method_access::update;
+            static constexpr auto update_chunk_method  = &method_access::update_chunk;
+            static constexpr auto before_update_method = &method_access::before_update;
+            static constexpr auto after_update_method  = &method_access::after_update;
+        };
+
+        inline hooks_type& hooks()
+        {
+            return static_cast<hooks_type&>( *this );
+        }
+        inline void call_update( entity_components& components )
+        {
+            ( hooks().*method_access<hooks_type>::update_method )( components );
+        }
+        inline void call_update_chunk( chunk_components& chunk )
+        {
+            ( hooks().*method_access<hooks_type>::update_chunk_method )( chunk );
+        }
+        inline void call_before_update()
+        {
+            ( hooks().*method_access<hooks_type>::before_update_method )();
+        }
+        inline void call_after_update()
+        {
+            ( hooks().*method_access<hooks_type>::after_update_method )();
+        }
+
+        private: // members
+        usize batch_count = 1;
+        // The change tick this system last updated at, so changed<T> only visits components changed after it
+        change_tick last_update_tick = 0;
+
+        private: // constants
+        static constexpr usize invalid_count = ~usize( 0 );
+
+        private: // helpers for coercing compile-time data using the type system
+        // Error case of finding an index of a tuple by type
+        //      Should return an index that is out of bounds
+        template <typename T_search, usize N, typename... Ts>
+        struct get_tuple_index_by_type
+        {
+            static constexpr usize index = N;
+        };
+        // Terminal case of finding an index of a tuple by type
+        //      value is the number of steps it took to get here
+        template <typename T_search, usize N, typename... T_rest>
+        struct get_tuple_index_by_type<T_search, N, T_search, T_rest...>
+        {
+            static constexpr usize index = N;
+        };
+        // Non-terminal case of finding an index of a tuple by type
+        //      Continue search in rest of types
+        template <typename T_search, usize N, typename T_first, typename... T_rest>
+        struct get_tuple_index_by_type<T_search, N, T_first, T_rest...>
+        {
+            static constexpr usize index = get_tuple_index_by_type<T_search, N + 1, T_rest...>::index;
+        };
+
+        private: // helpers
+        // Terminal case (no accessors left)
+        // note: could still have invalid template parameters (not read_from or write_to), but that
+        //       should already give an error elsewhere
+        template <bool ordered, typename... Ts>
+        struct entity_iterator
+        {
+            // If we've gotten here, all parent iterators have returned true
+            inline bool has( entity::id target )
             {
-                entity_components result = others.get_next_append( previous..., read_from( ( *component_iterator ).component_data ) );
-                component_iterator.advance();
-                return result;
+                return true;
             }
 
-            private:
-            entity_iterator<T_rest...> others;
+            // All parent iterators have constructed parameters, so return the final structure
+            template <typename... Ps>
+            inline entity_components get_next_append( Ps... previous )
+            {
+                return entity_components( previous... );
+            }
         };
 
-        // note: virtually the same as above
-        // TODO: create a single base template that these can specialize, if possible
-        template <typename T_first, typename... T_rest>
-        struct entity_iterator<write_to<T_first>, T_rest...>
+        // note: `ordered` is true when the 'top-level' iterator visits owner IDs in increasing order (ie its
+        //       component type is stored sorted by owner), so sorted 'child' iterators can follow along in lockstep.
+        //       Otherwise (or if a child's component type isn't sorted), children look up each target ID directly
+        template <bool ordered, typename A_first, typename... A_rest>
+        struct entity_iterator<ordered, A_first, A_rest...>
         {
-            // note: these lines vary between read_from and write_to cases
-            entity_iterator() : component_iterator( T_first::get_mutable_iterator() ) {}
-            mutable_iterator<typename component<T_first>::owned_component> component_iterator;
+            using component_type  = typename A_first::accessed_type;
+            using owned_component = typename component_type::owned_component;
+
+            // Whether this iterator advances alongside the 'top-level' one, or looks up targets directly
+            static constexpr bool lockstep = ordered and component_type::is_sorted_by_owner and not A_first::is_filter;
+
+            entity_iterator() : component_iterator( component_type::get_mutable_iterator() ), current( nullptr ) {}
 
             // Move all iterators along until they are all at the same ID.
             // returns true if such an entry exists, false otherwise
-            // note: only called on the 'top-level' entity_iterator
-            // note: this method doesn't vary between read_from and write_to cases
+            // note: meant to only be called on the 'top-level' entity_iterator
             inline bool has_next()
             {
                 // Keep going in this iterator until it's invalid
@@ -257,13 +742,14 @@ namespace rnjin::ecs
                     // Get the current entry for this component access iterator
                     let next_id = ( *component_iterator ).get_owner_id();
 
-                    // Advance other iterators as needed until a match is found or we know one won't be found
-                    // (other iterator points to a higher ID, or is invalid)
-                    bool others_have_id = others.has( next_id );
+                    // Check the entity's signature first, then advance other iterators as needed until a match is found
+                    // or we know one won't be found (other iterator points to a higher ID, or is invalid)
+                    bool others_have_id = matches_signature( next_id ) and others.has( next_id );
 
                     if ( others_have_id )
                     {
                         // All other iterators have the same ID, so leave state as-is and return true
+                        current = &( *component_iterator );
                         return true;
                     }
                     else
@@ -280,10 +766,25 @@ namespace rnjin::ecs
 
             // Move all iterators forward until they match the target ID or we know they will never match
             // (points to higher ID, or is invalid). Returns true if all iterators were able to align, false otherwise
-            // note: only called on 'child' entity_iterators, called from has_next of the 'top-level'
-            // note: this method doesn't vary between read_from and write_to cases
+            // note: meant to only be called on 'child' entity_iterators, called from has_next of the 'top-level'
             inline bool has( entity::id target )
             {
+                // Filters have already been checked against the target's signature, so only optional<T> needs a lookup
+                if constexpr ( A_first::is_filter )
+                {
+                    if constexpr ( A_first::is_fetched )
+                    {
+                        current = component_type::get_owned_component( target );
+                    }
+                    return others.has( target );
+                }
+                // Component types that aren't visited in order just look up the target directly
+                else if constexpr ( not lockstep )
+                {
+                    current = component_type::get_owned_component( target );
+                    return current != nullptr and others.has( target );
+                }
+
                 while ( component_iterator.is_valid() )
                 {
                     let next_id = ( *component_iterator ).get_owner_id();
@@ -291,6 +792,7 @@ namespace rnjin::ecs
                     if ( next_id == target )
                     {
                         // This iterator has aligned, so leave state as-is and check the next
+                        current = &( *component_iterator );
                         return others.has( target );
                     }
                     else if ( next_id > target )
@@ -311,27 +813,116 @@ namespace rnjin::ecs
 
             // Go through each iterator and collect all current entries into an entity_components structure
             // note: called on 'top-level' entity_iterator, calls get_next_append to aggregate references into final structure
-            // note: this method varies between read_from and write_to cases
             inline entity_components get_next()
             {
-                entity_components result = others.get_next_append( write_to( ( *component_iterator ).component_data ) );
+                entity_components result = others.get_next_append( access<A_first>( current ) );
                 component_iterator.advance();
                 return result;
             }
 
             // Go through each remaining iterator and collect current entries into an entity_components structure
             // note: called on 'child' entity_iterators from get_next in the 'top-level' one
-            // note: this method varies between read_from and write_to cases
-            template <typename... Ts>
-            inline entity_components get_next_append( Ts... previous )
+            template <typename... Ps>
+            inline entity_components get_next_append( Ps... previous )
             {
-                entity_components result = others.get_next_append( previous..., write_to( ( *component_iterator ).component_data ) );
-                component_iterator.advance();
+                entity_components result = others.get_next_append( previous..., access<A_first>( current ) );
+                if constexpr ( lockstep and not A_first::is_filter )
+                {
+                    component_iterator.advance();
+                }
                 return result;
             }
 
             private:
-            entity_iterator<T_rest...> others;
+            decltype( component_type::get_mutable_iterator() ) component_iterator;
+            owned_component* current;
+
+            entity_iterator<ordered, A_rest...> others;
         };
+
+        // The 'top-level' iterator (first accessor) determines the order entities are visited in
+        using first_accessor_type = std::tuple_element_t<0, std::tuple<accessor_types...>>;
+        using first_component_type = typename first_accessor_type::accessed_type;
+        using top_level_iterator   = entity_iterator<first_component_type::is_sorted_by_owner, accessor_types...>;
+
+        // Iterator that looks up all but the first accessor's components by owner ID
+        template <typename A_first, typename... A_rest>
+        struct split_accessors
+        {
+            using others_lookup_iterator = entity_iterator<false, A_rest...>;
+        };
+        using others_lookup_iterator = typename split_accessors<accessor_types...>::others_lookup_iterator;
+
+        // Whether every accessor that fetches components refers to a different component type
+        // note: required for parallel updates, so a component is never both read and written (or written twice) by one update
+        template <typename T>
+        static constexpr usize access_count = ( usize( accessor_types::is_fetched and std::is_same_v<T, typename accessor_types::accessed_type> ) + ... );
+        static constexpr bool accessed_types_are_unique = ( ( not accessor_types::is_fetched or access_count<typename accessor_types::accessed_type> == 1 ) and ... );
+
+        // Filters can't be the first accessor, since it decides which components are visited
+        static constexpr usize filter_count = ( usize( accessor_types::is_filter ) + ... );
+        static_assert( not first_accessor_type::is_filter, "A system's first accessor can't be with<T>, without<T> or optional<T>" );
+
+        // Whether entities can ever be updated in chunks (see update_chunk)
+        // note: paged components aren't contiguous, so systems accessing them never are
+        static constexpr bool is_chunkable = filter_count == 0 and not first_accessor_type::is_change_filter and ( ( accessor_types::accessed_type::storage != storage_mode::paged ) and ... );
+
+        // Only the first accessor can filter on changes, since it decides which components are visited
+        static constexpr usize change_filter_count = ( usize( accessor_types::is_change_filter ) + ... );
+        static_assert( change_filter_count == 0 or ( change_filter_count == 1 and first_accessor_type::is_change_filter ), "Only a system's first accessor can be changed<T>" );
+    };
+
+    // Base class to derive new systems from
+    // note: systems are defined on the set of components they work with, tagged
+    //       with read_from<T> or write_to<T> depending on how each component needs
+    //       to be accessed (ex. my_system : public system<read_from<my_component>, write_to<other_component>>)
+    // note: after the first accessor, with<T>, without<T> and optional<T> filter which entities are visited without
+    //       requiring their components to be fetched (ex. system<read_from<model>, without<model_resources>>)
+    template <typename... accessor_types>
+    class system : public basic_system<void, accessor_types...>
+    {
+        protected: // types
+        using typename basic_system<void, accessor_types...>::entity_components;
+        using typename basic_system<void, accessor_types...>::chunk_components;
+
+        protected: // virtual methods
+        virtual void update( entity_components& components ) pure_virtual;
+
+        // Update a chunk of entities whose components are laid out at the same indices of each type's list
+        // note: called instead of update when entities can be visited in chunks (an archetype packs exactly this system's
+        //       component types, or the system only accesses a single component type) and there are no filters, so
+        //       overriding it lets the update body loop over plain arrays instead of making a virtual call per entity
+        // note: by default, calls update for each entity in the chunk
+        virtual void update_chunk( chunk_components& chunk )
+        {
+            this->update_chunk_entities( chunk, std::index_sequence_for<accessor_types...>() );
+        }
+
+        virtual void before_update() {}
+        virtual void after_update() {}
+    };
+
+    // Base class for systems whose update methods are called directly rather than virtually, so the compiler can inline
+    // `update` into the loops over entities
+    // ex. `class my_system : public static_system<my_system, read_from<my_component>> { protected: void update( entity_components& components ) {...} };`
+    // note: derived types define update (and optionally update_chunk, before_update and after_update) the same way as for
+    //       system<...>, just without `override`, and must derive publicly from static_system and not be final
+    // note: still usable through system_base (ex. in a scheduler), since only update_all is virtual
+    template <typename derived_type, typename... accessor_types>
+    class static_system : public basic_system<derived_type, accessor_types...>
+    {
+        protected: // types
+        using typename basic_system<derived_type, accessor_types...>::entity_components;
+        using typename basic_system<derived_type, accessor_types...>::chunk_components;
+
+        protected: // default update methods (hidden by derived types' own)
+        // note: by default, calls update for each entity in the chunk
+        void update_chunk( chunk_components& chunk )
+        {
+            this->update_chunk_entities( chunk, std::index_sequence_for<accessor_types...>() );
+        }
+
+        void before_update() {}
+        void after_update() {}
     };
 } // namespace rnjin::ecs
\ No newline at end of file
@@ -0,0 +1,119 @@
+/* *** ** *** ** *** ** *** *
+ * Part of rnjin            *
+ * (c) Rajin Shankar, 2019  *
+ *        rajinshankar.com  *
+ * *** ** *** ** *** ** *** */
+
+#pragma once
+#include <rnjin.hpp>
+
+#include <atomic>
+#include <memory>
+
+#include "signature.hpp"
+#include "entity.hpp"
+
+#include "core/module.h"
+
+namespace rnjin::ecs
+{
+    // A counter that advances each time a system updates, so components can record when they last changed
+    // note: a system that starts updating at tick N sees changes made at ticks after its previous update's tick, and
+    //       anything changed during or after its update gets a tick later than N
+    // note: each world has its own tick (see world::get_change_tick)
+    using change_tick = uint;
+
+    // Base type of the per-world state of a component type (see component::get_state)
+    class component_storage_base
+    {
+        public: // methods
+        virtual ~component_storage_base() {}
+    };
+
+    // An independent set of entities and components: owns the components of every type, the table of entity ids and
+    // signatures, and the change tick
+    // ex. `world preview; world_scope scope( preview ); entity camera; camera.add<transform>();`
+    // note: entities, entity batches, archetypes, command buffers and systems belong to the world that's current on
+    //       their thread when they're created (see world_scope), and components always live in their owner's world
+    // note: worlds share no mutable state, so different worlds can be updated on different threads at the same time
+    // note: a world must outlive everything that belongs to it
+    class world
+    {
+        public: // methods
+        world();
+        ~world();
+        no_copy( world );
+
+        // Get the state of a component type in this world, creating it the first time the type is used here
+        // note: creating state isn't thread safe, so systems touch the state of each type they access before
+        //       updating in parallel
+        template <typename storage_type>
+        storage_type& get_component_storage( const component_type_index type_index )
+        {
+            let_mutable& storage = component_storages[type_index];
+            if ( storage == nullptr )
+            {
+                storage = std::make_unique<storage_type>();
+            }
+            return static_cast<storage_type&>( *storage );
+        }
+
+        // Get the tick to record for changes made now
+        change_tick get_change_tick() const;
+        // Advance the tick, returning the one a system starting to update now should use
+        change_tick advance_change_tick();
+
+        // Get an unused entity id for a new entity, reusing the indices of destroyed entities first
+        entity_id allocate_entity_id( entity& new_entity );
+        // Release the id of a destroyed entity, so its index can be reused with a new generation
+        void release_entity_id( const entity_id id );
+
+        // Get the live entity with a given id, or nullptr if it has been destroyed
+        // note: used to find the owners of restored components (see snapshot)
+        entity* get_entity( const entity_id id ) const;
+
+        // Get the set of component types owned by the entity with a given id (empty for unknown ids)
+        const signature& get_signature( const entity_id id ) const;
+        signature& get_mutable_signature( const entity_id id );
+
+        // Check that an id belongs to an entity of this world that hasn't been destroyed
+        bool is_alive( const entity_id id ) const;
+
+        public: // static methods
+        // Get the world used by threads that haven't entered another one
+        static world& get_default();
+        // Get the world that's current on the calling thread
+        static world& get_current();
+
+        private: // members
+        friend class world_scope;
+
+        // State of each component type used in this world, indexed by component type index
+        // note: a fixed-size table, so looking up an existing type's state never races with another type's creation
+        std::unique_ptr<component_storage_base> component_storages[max_component_types];
+
+        // Start ticks at 1, so components added before any system updates count as changed for every system
+        std::atomic<change_tick> current_change_tick;
+
+        // Per-entity data, indexed by entity id value
+        // note: index 0 is reserved so default-constructed ids are invalid
+        list<entity_id::value_type> generations;
+        list<signature> signatures;
+        list<entity*> entities;
+        // Indices of destroyed entities, to be reused by new ones
+        list<entity_id::value_type> free_indices;
+    };
+
+    // Makes a world current on the calling thread for as long as the scope exists, restoring the previous one afterwards
+    // ex. `std::thread shard( [&] { world_scope scope( shard_world ); run_shard(); } );`
+    class world_scope
+    {
+        public: // methods
+        world_scope( world& target );
+        ~world_scope();
+        no_copy( world_scope );
+
+        private: // members
+        world* previous;
+    };
+} // namespace rnjin::ecs
@@ -0,0 +1,163 @@
+/* *** ** *** ** *** ** *** *
+ * Part of rnjin            *
+ * (c) Rajin Shankar, 2019  *
+ *        rajinshankar.com  *
+ * *** ** *** ** *** ** *** */
+
+#include <rnjin.hpp>
+
+#include "test/module.h"
+#include "ecs/module.h"
+
+using namespace rnjin::ecs;
+
+// A sparse component type with a single float position value
+component_class_with_storage( packed_position, sparse_set )
+{
+    public:
+    packed_position( float value ) : value( value ) {}
+    ~packed_position() {}
+
+    void move_by( float amount )
+    {
+        value += amount;
+    }
+
+    public: // accessors
+    let get_position get_value( value );
+
+    private:
+    float value;
+};
+
+// A sparse component type with a single float velocity value
+component_class_with_storage( packed_velocity, sparse_set )
+{
+    public:
+    packed_velocity( float value ) : value( value ) {}
+    ~packed_velocity() {}
+
+    public: // accessors
+    let get_velocity get_value( value );
+
+    private:
+    float value;
+};
+
+// A system that moves positions by their velocities, and counts how many entities it visits
+class packed_movement_system : public rnjin::ecs::system<read_from<packed_velocity>, write_to<packed_position>>
+{
+    public: // accessors
+    let get_visit_count get_value( visit_count );
+
+    protected: // inherited
+    void define() override {}
+    void before_update() override
+    {
+        visit_count = 0;
+    }
+    void update( entity_components& components ) override
+    {
+        let& velocity         = components.readable<packed_velocity>();
+        let_mutable& position = components.writable<packed_position>();
+
+        position.move_by( velocity.get_velocity() );
+        visit_count += 1;
+    }
+
+    private: // members
+    int visit_count = 0;
+};
+
+test( ecs_archetype_packing )
+{
+    entity ent1, ent2, ent3, ent4;
+    packed_movement_system movement;
+
+    // Entities that already own both component types are packed when the archetype is created
+    record( ent1.add<packed_position>( 1.0 ) );
+    record( ent1.add<packed_velocity>( 10.0 ) );
+    record( ent2.add<packed_position>( 2.0 ) );
+
+    archetype<packed_position, packed_velocity> moving;
+    assert_equal( moving.get_count(), 1 );
+    assert_equal( moving.is_packed( ent1.get_id() ), true );
+    assert_equal( moving.is_packed( ent2.get_id() ), false );
+
+    // Entities are packed as soon as they own all component types
+    record( ent3.add<packed_velocity>( 30.0 ) );
+    record( ent4.add<packed_position>( 4.0 ) );
+    record( ent4.add<packed_velocity>( 40.0 ) );
+    record( ent3.add<packed_position>( 3.0 ) );
+    assert_equal( moving.get_count(), 3 );
+
+    // The system only visits the packed range
+    record( movement.update_all() );
+    assert_equal( movement.get_visit_count(), 3 );
+    assert_equal( ent1.get<packed_position>()->get_position(), 11.0 );
+    assert_equal( ent2.get<packed_position>()->get_position(), 2.0 );
+    assert_equal( ent3.get<packed_position>()->get_position(), 33.0 );
+    assert_equal( ent4.get<packed_position>()->get_position(), 44.0 );
+
+    // Removing a component unpacks the entity, keeping the rest packed
+    record( ent1.remove<packed_velocity>() );
+    assert_equal( moving.get_count(), 2 );
+    assert_equal( moving.is_packed( ent1.get_id() ), false );
+
+    record( movement.update_all() );
+    assert_equal( movement.get_visit_count(), 2 );
+    assert_equal( ent1.get<packed_position>()->get_position(), 11.0 );
+    assert_equal( ent3.get<packed_position>()->get_position(), 63.0 );
+    assert_equal( ent4.get<packed_position>()->get_position(), 84.0 );
+    assert_equal( ent4.get<packed_velocity>()->get_velocity(), 40.0 );
+}
+
+test( ecs_archetype_references )
+{
+    entity ent1, ent2, ent3;
+    archetype<packed_position, packed_velocity> moving;
+
+    record( ent1.add<packed_position>( 1.0 ) );
+    record( ent2.add<packed_position>( 2.0 ) );
+    record( ent3.add<packed_position::reference>( &ent2 ) );
+
+    // Packing ent2 swaps its position to the front of the list, and the reference should follow it
+    record( ent2.add<packed_velocity>( 20.0 ) );
+    assert_equal( moving.is_packed( ent2.get_id() ), true );
+    assert_equal( ent3.get<packed_position::reference>()->get_pointer()->get_position(), 2.0 );
+
+    record( ent2.remove<packed_velocity>() );
+    assert_equal( ent3.get<packed_position::reference>()->get_pointer()->get_position(), 2.0 );
+}
+
+test( ecs_archetype_conflicts )
+{
+    entity ent1, ent2;
+    record( ent1.add<packed_position>( 1.0 ) );
+    record( ent1.add<packed_velocity>( 10.0 ) );
+
+    archetype<packed_position, packed_velocity> moving;
+    assert_equal( moving.get_count(), 1 );
+
+    // An archetype of component types owned by another archetype claims none of them and packs nothing
+    {
+        archetype<packed_velocity, packed_position> conflicting;
+        assert_equal( conflicting.get_count(), 0 );
+    }
+
+    // The first archetype keeps its types, even after the conflicting one is destroyed
+    record( ent2.add<packed_velocity>( 20.0 ) );
+    record( ent2.add<packed_position>( 2.0 ) );
+    assert_equal( moving.get_count(), 2 );
+    assert_equal( moving.is_packed( ent2.get_id() ), true );
+}
+
+/* -------------------------------------------------------------------------- */
+/*                               Reflection Info                              */
+/* -------------------------------------------------------------------------- */
+
+namespace reflection
+{
+    auto_reflect_component(, packed_position );
+    auto_reflect_component(, packed_velocity );
+} // namespace reflection
@@ -0,0 +1,128 @@
+/* *** ** *** ** *** ** *** *
+ * Part of rnjin            *
+ * (c) Rajin Shankar, 2019  *
+ *        rajinshankar.com  *
+ * *** ** *** ** *** ** *** */
+
+#include <rnjin.hpp>
+
+#include "test/module.h"
+#include "ecs/module.h"
+
+#include "test_components.hpp"
+
+using namespace rnjin;
+using namespace rnjin::ecs;
+
+// A sparse component type that mirrors a test_value
+component_class_with_storage( tracked_mirror, sparse_set )
+{
+    public:
+    tracked_mirror() : value( 0 ) {}
+    ~tracked_mirror() {}
+
+    public: // members
+    int value;
+};
+
+// Copies changed values into mirrors, counting how many it visits
+class mirror_system : public rnjin::ecs::system<changed<test_value>, write_to<tracked_mirror>>
+{
+    public: // accessors
+    let get_visited_count get_value( visited_count );
+
+    protected: // inherited
+    void define() override {}
+    void before_update() override
+    {
+        visited_count = 0;
+    }
+    void update( entity_components& components ) override
+    {
+        components.writable<tracked_mirror>().value = components.readable<test_value>().get_int_value();
+        visited_count += 1;
+    }
+
+    private: // members
+    int visited_count = 0;
+};
+
+// Sets every value, so the values count as changed for other systems
+class value_writer_system : public rnjin::ecs::system<write_to<test_value>>
+{
+    protected: // inherited
+    void define() override {}
+    void update( entity_components& components ) override
+    {
+        let_mutable& value = components.writable<test_value>();
+        value.set_int_value( value.get_int_value() + 1 );
+    }
+};
+
+test( ecs_changed_filter )
+{
+    const int entity_count = 200;
+    entity_batch batch( entity_count );
+    record( batch.add_each<test_value>( []( const usize index ) { return test_value( (int) index ); } ) );
+    record( batch.add<tracked_mirror>() );
+
+    mirror_system mirror;
+
+    // Newly added components count as changed
+    record( mirror.update_all() );
+    assert_equal( mirror.get_visited_count(), entity_count );
+    assert_equal( batch[150].get<tracked_mirror>()->value, 150 );
+
+    // Nothing changed since the last update
+    record( mirror.update_all() );
+    assert_equal( mirror.get_visited_count(), 0 );
+
+    // Components marked as changed (including by other systems writing to them) are visited once
+    record( batch[3].get_mutable<test_value>()->set_int_value( 30 ) );
+    record( batch[3].get<test_value>()->mark_changed() );
+    record( batch[170].get_mutable<test_value>()->set_int_value( 1700 ) );
+    record( batch[170].get<test_value>()->mark_changed() );
+    record( mirror.update_all() );
+    assert_equal( mirror.get_visited_count(), 2 );
+    assert_equal( batch[3].get<tracked_mirror>()->value, 30 );
+    assert_equal( batch[170].get<tracked_mirror>()->value, 1700 );
+
+    // Writing through write_to marks every visited component as changed
+    value_writer_system writer;
+    record( writer.update_all() );
+    record( mirror.update_all_parallel( 16 ) );
+    assert_equal( mirror.get_visited_count(), entity_count );
+    assert_equal( batch[3].get<tracked_mirror>()->value, 31 );
+
+    record( mirror.update_all() );
+    assert_equal( mirror.get_visited_count(), 0 );
+}
+
+test( ecs_changed_filter_moves )
+{
+    entity later;
+    entity_batch batch( 100 );
+    record( batch.add<test_value>( 1 ) );
+    record( batch.add<tracked_mirror>() );
+
+    mirror_system mirror;
+    record( mirror.update_all() );
+
+    // Components moved by an insertion keep their own change ticks, so only the new one is visited
+    record( later.add<test_value>( 5 ) );
+    record( later.add<tracked_mirror>() );
+    record( mirror.update_all() );
+    assert_equal( mirror.get_visited_count(), 1 );
+    assert_equal( later.get<tracked_mirror>()->value, 5 );
+}
+
+/* -------------------------------------------------------------------------- */
+/*                               Reflection Info                              */
+/* -------------------------------------------------------------------------- */
+
+namespace reflection
+{
+    auto_reflect_component(, tracked_mirror );
+    auto_reflect_type(, mirror_system );
+    auto_reflect_type(, value_writer_system );
+} // namespace reflection
@@ -0,0 +1,141 @@
+/* *** ** *** ** *** ** *** *
+ * Part of rnjin            *
+ * (c) Rajin Shankar, 2019  *
+ *        rajinshankar.com  *
+ * *** ** *** ** *** ** *** */
+
+#include <rnjin.hpp>
+
+#include "test/module.h"
+#include "ecs/module.h"
+
+using namespace rnjin;
+using namespace rnjin::ecs;
+
+// A sparse component type with a position along one axis
+component_class_with_storage( chunk_position, sparse_set )
+{
+    public:
+    chunk_position( float x ) : x( x ) {}
+    ~chunk_position() {}
+
+    public: // members
+    float x;
+};
+
+// A sparse component type with a velocity along one axis
+component_class_with_storage( chunk_velocity, sparse_set )
+{
+    public:
+    chunk_velocity( float dx ) : dx( dx ) {}
+    ~chunk_velocity() {}
+
+    public: // members
+    float dx;
+};
+
+// Integrates positions one entity at a time
+class per_entity_integrator : public rnjin::ecs::system<read_from<chunk_velocity>, write_to<chunk_position>>
+{
+    protected: // inherited
+    void define() override {}
+    void update( entity_components& components ) override
+    {
+        components.writable<chunk_position>().x += components.readable<chunk_velocity>().dx;
+    }
+};
+
+// Integrates positions a chunk at a time
+class chunk_integrator : public rnjin::ecs::system<read_from<chunk_velocity>, write_to<chunk_position>>
+{
+    public: // accessors
+    let get_chunk_count get_value( chunk_count );
+
+    protected: // inherited
+    void define() override {}
+    void before_update() override
+    {
+        chunk_count = 0;
+    }
+    void update( entity_components& components ) override {}
+    void update_chunk( chunk_components& chunk ) override
+    {
+        let velocities = chunk.readable<chunk_velocity>();
+        let positions  = chunk.writable<chunk_position>();
+        for ( usize i = 0; i < chunk.get_count(); i++ )
+        {
+            positions[i].x += velocities[i].dx;
+        }
+        chunk_count += 1;
+    }
+
+    private: // members
+    usize chunk_count = 0;
+};
+
+// Integrates positions one entity at a time, with update called directly rather than virtually
+class static_integrator : public rnjin::ecs::static_system<static_integrator, read_from<chunk_velocity>, write_to<chunk_position>>
+{
+    public: // accessors
+    let get_update_count get_value( update_count );
+
+    public: // methods
+    void define() override {}
+
+    protected: // update methods
+    void before_update()
+    {
+        update_count = 0;
+    }
+    void update( entity_components& components )
+    {
+        components.writable<chunk_position>().x += components.readable<chunk_velocity>().dx;
+        update_count += 1;
+    }
+
+    private: // members
+    usize update_count = 0;
+};
+
+test( ecs_chunk_updates )
+{
+    const usize entity_count = 5000;
+    archetype<chunk_position, chunk_velocity> moving;
+
+    entity_batch batch( entity_count );
+    record( batch.add_each<chunk_position>( []( const usize index ) { return chunk_position( float( index ) ); } ) );
+    record( batch.add<chunk_velocity>( 1.0f ) );
+
+    // Packed entities are updated in chunks of archetype_base::chunk_size
+    chunk_integrator chunked;
+    record( chunked.update_all() );
+    assert_equal( chunked.get_chunk_count(), ( entity_count + archetype_base::chunk_size - 1 ) / archetype_base::chunk_size );
+    assert_equal( batch[10].get<chunk_position>()->x, 11.0f );
+
+    // Systems that only implement update see the same results
+    per_entity_integrator per_entity;
+    record( per_entity.update_all() );
+    record( chunked.update_all_parallel( 1000 ) );
+    assert_equal( chunked.get_chunk_count(), 5 );
+    assert_equal( batch[10].get<chunk_position>()->x, 13.0f );
+    assert_equal( batch[4999].get<chunk_position>()->x, 5002.0f );
+
+    // Static systems call their own update methods without virtual dispatch
+    static_integrator statically_dispatched;
+    record( statically_dispatched.update_all() );
+    assert_equal( statically_dispatched.get_update_count(), entity_count );
+    assert_equal( batch[10].get<chunk_position>()->x, 14.0f );
+}
+
+/* -------------------------------------------------------------------------- */
+/*                               Reflection Info                              */
+/* -------------------------------------------------------------------------- */
+
+namespace reflection
+{
+    auto_reflect_component(, chunk_position );
+    auto_reflect_component(, chunk_velocity );
+    auto_reflect_type(, per_entity_integrator );
+    auto_reflect_type(, chunk_integrator );
+    auto_reflect_type(, static_integrator );
+} // namespace reflection
@@ -0,0 +1,100 @@
+/* *** ** *** ** *** ** *** *
+ * Part of rnjin            *
+ * (c) Rajin Shankar, 2019  *
+ *        rajinshankar.com  *
+ * *** ** *** ** *** ** *** */
+
+#include <rnjin.hpp>
+
+#include "test/module.h"
+#include "ecs/module.h"
+
+#include "test_components.hpp"
+
+using namespace rnjin::ecs;
+
+test( ecs_command_buffer_sorted )
+{
+    entity ent1, ent2, ent3, ent4, ent5, ent6, ref4, ref6;
+    command_buffer changes;
+
+    record( ent2.add<test_value>( 2 ) );
+    record( ent4.add<test_value>( 4 ) );
+    record( ent6.add<test_value>( 6 ) );
+    record( ref4.add<test_value::reference>( &ent4 ) );
+    record( ref6.add<test_value::reference>( &ent6 ) );
+
+    // Nothing changes until the buffer is applied
+    record( changes.add<test_value>( ent5, 5 ) );
+    record( changes.add<test_value>( ent1, 1 ) );
+    record( changes.add<test_value>( ent3, 3 ) );
+    record( changes.remove<test_value>( ent2 ) );
+    assert_equal( ent1.get<test_value>() == nullptr, true );
+    assert_equal( ent2.get<test_value>()->get_int_value(), 2 );
+    assert_equal( changes.is_empty(), false );
+
+    record( changes.apply() );
+    assert_equal( changes.is_empty(), true );
+    assert_equal( ent1.get<test_value>()->get_int_value(), 1 );
+    assert_equal( ent2.get<test_value>() == nullptr, true );
+    assert_equal( ent3.get<test_value>()->get_int_value(), 3 );
+    assert_equal( ent4.get<test_value>()->get_int_value(), 4 );
+    assert_equal( ent5.get<test_value>()->get_int_value(), 5 );
+    assert_equal( ent6.get<test_value>()->get_int_value(), 6 );
+
+    // References follow their components through the rebuilt list
+    assert_equal( ref4.get<test_value::reference>()->get_pointer()->get_int_value(), 4 );
+    assert_equal( ref6.get<test_value::reference>()->get_pointer()->get_int_value(), 6 );
+
+    // Removing a component added in the same buffer cancels the addition
+    record( changes.add<test_value>( ent2, 20 ) );
+    record( changes.remove<test_value>( ent2 ) );
+    assert_equal( changes.is_empty(), true );
+
+    // Removals on their own only rebuild the list after the first removed component
+    record( changes.remove<test_value>( ent1 ) );
+    record( changes.apply() );
+    assert_equal( ent1.get<test_value>() == nullptr, true );
+    assert_equal( ref4.get<test_value::reference>()->get_pointer()->get_int_value(), 4 );
+}
+
+test( ecs_command_buffer_destroy )
+{
+    entity ent1, ref1;
+    entity* temporary = new entity();
+    command_buffer changes;
+
+    record( ent1.add<test_value>( 1 ) );
+    record( ref1.add<test_value::reference>( &ent1 ) );
+    record( temporary->add<test_value>( 100 ) );
+
+    // Changes recorded for a destroyed entity are dropped
+    record( changes.add<test_sparse_value>( *temporary, 100 ) );
+    record( changes.destroy( temporary ) );
+    record( changes.apply() );
+
+    assert_equal( changes.is_empty(), true );
+    assert_equal( ent1.get<test_value>()->get_int_value(), 1 );
+    assert_equal( ref1.get<test_value::reference>()->get_pointer()->get_int_value(), 1 );
+}
+
+test( ecs_command_buffer_sparse_set )
+{
+    entity ent1, ent2, ent3;
+    command_buffer changes;
+
+    record( ent1.add<test_sparse_value>( 1 ) );
+
+    record( changes.add<test_sparse_value>( ent3, 3 ) );
+    record( changes.add<test_sparse_value>( ent2, 2 ) );
+    record( changes.remove<test_sparse_value>( ent1 ) );
+
+    // Discarded changes are never applied
+    assert_equal( changes.discard( ent3 ), true );
+    assert_equal( changes.discard( ent3 ), false );
+
+    record( changes.apply() );
+    assert_equal( ent1.get<test_sparse_value>() == nullptr, true );
+    assert_equal( ent2.get<test_sparse_value>()->get_int_value(), 2 );
+    assert_equal( ent3.get<test_sparse_value>() == nullptr, true );
+}
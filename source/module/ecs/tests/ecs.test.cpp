@@ -225,6 +225,23 @@ test( ecs_references )
     assert_equal( ent5.get<int_component::reference>()->get_pointer()->get_int_value(), 1 );
 }
 
+test( ecs_stale_references )
+{
+    entity ent1, ent2, ent3;
+
+    record( ent1.add<int_component>( 1 ) );
+    record( ent2.add<int_component::reference>( &ent1 ) );
+    assert_equal( ent2.get<int_component::reference>()->is_valid(), true );
+
+    // The referenced component is destroyed, and its slot is reused by a new component
+    record( ent1.remove<int_component>() );
+    assert_equal( ent2.get<int_component::reference>()->is_valid(), false );
+    assert_equal( ent2.get<int_component::reference>()->get_pointer() == nullptr, true );
+
+    record( ent3.add<int_component>( 3 ) );
+    assert_equal( ent2.get<int_component::reference>()->is_valid(), false );
+}
+
 /* -------------------------------------------------------------------------- */
 /*                               Reflection Info                              */
 /* -------------------------------------------------------------------------- */
@@ -0,0 +1,164 @@
+/* *** ** *** ** *** ** *** *
+ * Part of rnjin            *
+ * (c) Rajin Shankar, 2019  *
+ *        rajinshankar.com  *
+ * *** ** *** ** *** ** *** */
+
+#include <rnjin.hpp>
+
+#include "test/module.h"
+#include "ecs/module.h"
+
+#include "test_components.hpp"
+
+using namespace rnjin;
+using namespace rnjin::ecs;
+
+// Sum of all test_value components, walked in order of their owners
+static int sum_batch_values()
+{
+    int sum = 0;
+    foreach ( owned : test_value::get_const_iterator() )
+    {
+        sum += owned.component_data.get_int_value();
+    }
+    return sum;
+}
+
+test( ecs_entity_batch_add )
+{
+    entity before;
+    record( before.add<test_value>( 1000 ) );
+
+    subregion
+    {
+        entity_batch batch( 100 );
+        record( batch.add<test_sparse_value>( 7 ) );
+        record( batch.add_each<test_value>( []( const usize index ) { return test_value( (int) index ); } ) );
+
+        assert_equal( batch.get_count(), 100 );
+        assert_equal( batch[0].get<test_sparse_value>()->get_int_value(), 7 );
+        assert_equal( batch[42].get<test_value>()->get_int_value(), 42 );
+        assert_equal( &batch[99].get<test_value>()->get_owner() == &batch[99], true );
+        assert_equal( sum_batch_values(), 1000 + 99 * 100 / 2 );
+
+        // Components can still be added and removed individually
+        record( batch[10].remove<test_value>() );
+        assert_equal( batch[10].get<test_value>() == nullptr, true );
+        assert_equal( sum_batch_values(), 1000 + 99 * 100 / 2 - 10 );
+
+        // Removing from the whole batch skips entities that don't own the component
+        record( batch.remove<test_sparse_value>() );
+        assert_equal( batch[0].get<test_sparse_value>() == nullptr, true );
+    }
+
+    // Destroying the batch removes its components, and leaves others in place
+    assert_equal( sum_batch_values(), 1000 );
+    assert_equal( before.get<test_value>()->get_int_value(), 1000 );
+}
+
+test( ecs_entity_batch_merge )
+{
+    // Entities created before the batch get components after it, so the batch's components are merged in front of them
+    entity_batch batch( 4 );
+    entity after;
+    record( after.add<test_value>( 100 ) );
+    record( after.add<test_value::reference>( &after ) );
+
+    record( batch.add<test_value>( 1 ) );
+
+    let* first    = test_value::get_owned_components();
+    let count     = test_value::get_owned_component_count();
+    bool in_order = true;
+    for ( usize i = 1; i < count; i++ )
+    {
+        in_order = in_order and first[i - 1].get_owner_id() < first[i].get_owner_id();
+    }
+    assert_equal( in_order, true );
+    assert_equal( sum_batch_values(), 104 );
+
+    // References follow components moved by the merge
+    assert_equal( after.get<test_value::reference>()->get_pointer()->get_int_value(), 100 );
+}
+
+// Counts batched events for both component types in a single world
+class batch_event_counter : public event_receiver
+{
+    public:
+    batch_event_counter( world& target )
+    {
+        handle_event( test_value::get_events( target ).added_batch(), &batch_event_counter::on_values_added );
+        handle_event( test_value::get_events( target ).removed_batch(), &batch_event_counter::on_values_removed );
+        handle_event( test_sparse_value::get_events( target ).added_batch(), &batch_event_counter::on_sparse_values_added );
+    }
+
+    void on_values_added( const test_value::added_span& added )
+    {
+        batch_count += 1;
+        foreach ( entry : added )
+        {
+            value_sum += entry.component->get_int_value();
+            owners_match = owners_match and &entry.component->get_owner() == entry.owner;
+        }
+    }
+    void on_values_removed( const test_value::removed_span& removed )
+    {
+        batch_count += 1;
+        foreach ( entry : removed )
+        {
+            value_sum -= entry.component->get_int_value();
+        }
+    }
+    void on_sparse_values_added( const test_sparse_value::added_span& added )
+    {
+        batch_count += 1;
+        sparse_count += added.size();
+    }
+
+    public: // members
+    int batch_count    = 0;
+    int value_sum      = 0;
+    usize sparse_count = 0;
+    bool owners_match  = true;
+};
+
+test( ecs_entity_batch_events )
+{
+    world event_world;
+    world_scope scope( event_world );
+    batch_event_counter counter( event_world );
+
+    // Adding to a whole batch sends a single batched event
+    entity_batch batch( 50 );
+    record( batch.add_each<test_value>( []( const usize index ) { return test_value( (int) index ); } ) );
+    record( batch.add<test_sparse_value>( 1 ) );
+    assert_equal( counter.batch_count, 2 );
+    assert_equal( counter.value_sum, 49 * 50 / 2 );
+    assert_equal( counter.sparse_count, 50 );
+    assert_equal( counter.owners_match, true );
+
+    // Individual changes are batches of one
+    entity single;
+    record( single.add<test_value>( 1000 ) );
+    assert_equal( counter.batch_count, 3 );
+    assert_equal( counter.value_sum, 49 * 50 / 2 + 1000 );
+
+    // So are the changes applied by a command buffer, for each component type
+    command_buffer changes;
+    for ( usize i = 0; i < 10; i++ )
+    {
+        changes.remove<test_value>( batch[i] );
+    }
+    record( changes.apply() );
+    assert_equal( counter.batch_count, 4 );
+    assert_equal( counter.value_sum, 49 * 50 / 2 + 1000 - 9 * 10 / 2 );
+}
+
+/* -------------------------------------------------------------------------- */
+/*                               Reflection Info                              */
+/* -------------------------------------------------------------------------- */
+
+namespace reflection
+{
+    auto_reflect_type(, batch_event_counter );
+} // namespace reflection
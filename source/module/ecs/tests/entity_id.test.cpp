@@ -0,0 +1,59 @@
+/* *** ** *** ** *** ** *** *
+ * Part of rnjin            *
+ * (c) Rajin Shankar, 2019  *
+ *        rajinshankar.com  *
+ * *** ** *** ** *** ** *** */
+
+#include <rnjin.hpp>
+
+#include <memory>
+
+#include "test/module.h"
+#include "ecs/module.h"
+
+#include "test_components.hpp"
+
+using namespace rnjin;
+using namespace rnjin::ecs;
+
+test( ecs_entity_id_recycling )
+{
+    std::unique_ptr<entity> first( new entity() );
+    let first_id = first->get_id();
+    record( first->add<test_sparse_value>( 1 ) );
+    assert_equal( entity::is_alive( first_id ), true );
+
+    // A destroyed entity's index is reused by the next entity, with a new generation
+    record( first.reset() );
+    assert_equal( entity::is_alive( first_id ), false );
+
+    entity second;
+    assert_equal( second.get_id().value(), first_id.value() );
+    assert_equal( second.get_id() != first_id, true );
+    assert_equal( entity::is_alive( first_id ), false );
+    assert_equal( entity::is_alive( second.get_id() ), true );
+
+    // The reused index doesn't carry over the destroyed entity's components
+    assert_equal( second.get<test_sparse_value>() == nullptr, true );
+    record( second.add<test_sparse_value>( 2 ) );
+    assert_equal( second.get<test_sparse_value>()->get_int_value(), 2 );
+
+    // Churning entities doesn't grow the id space
+    entity::id::value_type largest_index = 0;
+    for ( int i = 0; i < 100; i++ )
+    {
+        entity_batch batch( 50 );
+        record( batch.add<test_sparse_value>( i ) );
+        for ( usize j = 0; j < batch.get_count(); j++ )
+        {
+            largest_index = std::max( largest_index, batch[j].get_id().value() );
+        }
+    }
+    entity_batch last_batch( 50 );
+    for ( usize j = 0; j < last_batch.get_count(); j++ )
+    {
+        assert_equal( last_batch[j].get_id().value() <= largest_index, true );
+    }
+
+    assert_equal( entity::id::invalid().is_valid(), false );
+}
@@ -0,0 +1,153 @@
+/* *** ** *** ** *** ** *** *
+ * Part of rnjin            *
+ * (c) Rajin Shankar, 2019  *
+ *        rajinshankar.com  *
+ * *** ** *** ** *** ** *** */
+
+#include <rnjin.hpp>
+
+#include "test/module.h"
+#include "ecs/module.h"
+
+#include "test_components.hpp"
+
+using namespace rnjin;
+using namespace rnjin::ecs;
+
+// A sparse component type used only to tag entities
+component_class_with_storage( filtered_tag, sparse_set )
+{
+    public:
+    filtered_tag() {}
+    ~filtered_tag() {}
+};
+
+// A sorted component type that adds to a value when present
+component_class( filtered_bonus )
+{
+    public:
+    filtered_bonus( int amount ) : amount( amount ) {}
+    ~filtered_bonus() {}
+
+    public: // accessors
+    let get_amount get_value( amount );
+
+    private:
+    int amount;
+};
+
+// Sums the values of entities that are tagged
+class tagged_sum_system : public rnjin::ecs::system<read_from<test_value>, with<filtered_tag>>
+{
+    public: // accessors
+    let get_sum get_value( sum );
+
+    protected: // inherited
+    void define() override {}
+    void before_update() override
+    {
+        sum = 0;
+    }
+    void update( entity_components& components ) override
+    {
+        sum += components.readable<test_value>().get_int_value();
+    }
+
+    private: // members
+    int sum = 0;
+};
+
+// Sums the values of entities that aren't tagged, adding bonuses where they exist
+class untagged_sum_system : public rnjin::ecs::system<read_from<test_value>, without<filtered_tag>, optional<filtered_bonus>>
+{
+    public: // accessors
+    let get_sum get_value( sum );
+
+    protected: // inherited
+    void define() override {}
+    void before_update() override
+    {
+        sum = 0;
+    }
+    void update( entity_components& components ) override
+    {
+        sum += components.readable<test_value>().get_int_value();
+
+        let* bonus = components.optional<filtered_bonus>();
+        if ( bonus != nullptr )
+        {
+            sum += bonus->get_amount();
+        }
+    }
+
+    private: // members
+    int sum = 0;
+};
+
+test( ecs_system_filters )
+{
+    entity ent1, ent2, ent3, ent4;
+    record( ent1.add<test_value>( 1 ) );
+    record( ent2.add<test_value>( 10 ) );
+    record( ent3.add<test_value>( 100 ) );
+    record( ent4.add<filtered_tag>() );
+
+    record( ent2.add<filtered_tag>() );
+    record( ent3.add<filtered_tag>() );
+    record( ent1.add<filtered_bonus>( 1000 ) );
+
+    tagged_sum_system tagged;
+    untagged_sum_system untagged;
+
+    // ent4 is tagged, but has no value to read
+    record( tagged.update_all() );
+    assert_equal( tagged.get_sum(), 110 );
+
+    record( untagged.update_all() );
+    assert_equal( untagged.get_sum(), 1001 );
+
+    // Signatures follow components as they're removed
+    record( ent3.remove<filtered_tag>() );
+    record( tagged.update_all() );
+    assert_equal( tagged.get_sum(), 10 );
+    record( untagged.update_all_parallel( 1 ) );
+    assert_equal( untagged.get_sum(), 1101 );
+
+    // with<T> and without<T> don't access component data, so they don't conflict with writers
+    assert_equal( tagged.get_read_types().size(), 1 );
+    assert_equal( untagged.get_read_types().size(), 2 );
+}
+
+test( ecs_entity_signatures )
+{
+    let tag_index = filtered_tag::get_type_index();
+
+    // Destroyed entities leave an empty signature behind
+    std::unique_ptr<entity> destroyed( new entity() );
+    let destroyed_id = destroyed->get_id();
+    record( destroyed->add<filtered_tag>() );
+    assert_equal( entity::get_signature( destroyed_id ).has( tag_index ), true );
+    record( destroyed.reset() );
+    assert_equal( entity::get_signature( destroyed_id ).is_empty(), true );
+
+    entity_batch batch( 10 );
+    record( batch.add<filtered_tag>() );
+    assert_equal( entity::get_signature( batch[7].get_id() ).has( tag_index ), true );
+    assert_equal( batch[7].has<filtered_tag>(), true );
+    assert_equal( batch[7].has<test_value>(), false );
+    record( batch.remove<filtered_tag>() );
+    assert_equal( entity::get_signature( batch[7].get_id() ).has( tag_index ), false );
+    assert_equal( batch[7].has<filtered_tag>(), false );
+}
+
+/* -------------------------------------------------------------------------- */
+/*                               Reflection Info                              */
+/* -------------------------------------------------------------------------- */
+
+namespace reflection
+{
+    auto_reflect_component(, filtered_tag );
+    auto_reflect_component(, filtered_bonus );
+    auto_reflect_type(, tagged_sum_system );
+    auto_reflect_type(, untagged_sum_system );
+} // namespace reflection
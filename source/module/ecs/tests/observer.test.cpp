@@ -0,0 +1,131 @@
+/* *** ** *** ** *** ** *** *
+ * Part of rnjin            *
+ * (c) Rajin Shankar, 2019  *
+ *        rajinshankar.com  *
+ * *** ** *** ** *** ** *** */
+
+#include <rnjin.hpp>
+
+#include "test/module.h"
+#include "ecs/module.h"
+
+#include "test_components.hpp"
+
+using namespace rnjin;
+using namespace rnjin::ecs;
+
+// A paged component type with a single int value
+component_class_with_storage( observed_page, paged )
+{
+    public:
+    observed_page( int value ) : value( value ) {}
+
+    public: // members
+    int value;
+};
+
+// Counts the entities it visits, and which triggers fired for them
+class value_observer : public observer<on_add<test_value>, on_remove<test_value>, on_change<observed_page>>
+{
+    public: // accessors
+    let get_update_count get_value( update_count );
+    let get_visited_count get_value( visited_count );
+    let get_added_count get_value( added_count );
+    let get_removed_count get_value( removed_count );
+    let get_changed_count get_value( changed_count );
+    let get_destroyed_count get_value( destroyed_count );
+
+    protected: // inherited
+    void define() override {}
+    void before_update() override
+    {
+        update_count += 1;
+        visited_count = added_count = removed_count = changed_count = destroyed_count = 0;
+    }
+    void update( observed_entity& affected ) override
+    {
+        visited_count += 1;
+        added_count += affected.triggered_by<on_add<test_value>>() ? 1 : 0;
+        removed_count += affected.triggered_by<on_remove<test_value>>() ? 1 : 0;
+        changed_count += affected.triggered_by<on_change<observed_page>>() ? 1 : 0;
+        destroyed_count += affected.get_entity() == nullptr ? 1 : 0;
+    }
+
+    private: // members
+    int update_count    = 0;
+    int visited_count   = 0;
+    int added_count     = 0;
+    int removed_count   = 0;
+    int changed_count   = 0;
+    int destroyed_count = 0;
+};
+
+test( ecs_observer )
+{
+    world test_world;
+    world_scope scope( test_world );
+
+    value_observer values_observer;
+
+    const int entity_count = 100;
+    entity_batch batch( entity_count );
+    record( batch.add<test_value>( 1 ) );
+    record( batch.add<observed_page>( 1 ) );
+
+    note( "Additions" );
+    record( values_observer.update_all() );
+    assert_equal( values_observer.get_update_count(), 1 );
+    assert_equal( values_observer.get_visited_count(), entity_count );
+    assert_equal( values_observer.get_added_count(), entity_count );
+    assert_equal( values_observer.get_changed_count(), entity_count );
+
+    note( "Nothing Affected" );
+    record( values_observer.update_all() );
+    record( values_observer.update_all() );
+    assert_equal( values_observer.get_update_count(), 1 );
+
+    note( "Changes" );
+    record( batch[10].get<observed_page>()->mark_changed() );
+    record( batch[90].get<observed_page>()->mark_changed() );
+    record( batch[90].get<observed_page>()->mark_changed() );
+    record( values_observer.update_all() );
+    assert_equal( values_observer.get_update_count(), 2 );
+    assert_equal( values_observer.get_visited_count(), 2 );
+    assert_equal( values_observer.get_changed_count(), 2 );
+    assert_equal( values_observer.get_added_count(), 0 );
+
+    note( "Coalesced Triggers" );
+    record( batch[5].remove<test_value>() );
+    record( batch[5].add<test_value>( 2 ) );
+    record( batch[5].remove<test_value>() );
+    record( batch[5].add<test_value>( 3 ) );
+    record( batch[5].get<observed_page>()->mark_changed() );
+    record( values_observer.update_all() );
+    assert_equal( values_observer.get_visited_count(), 1 );
+    assert_equal( values_observer.get_added_count(), 1 );
+    assert_equal( values_observer.get_removed_count(), 1 );
+    assert_equal( values_observer.get_changed_count(), 1 );
+
+    note( "Destroyed Entities" );
+    subregion
+    {
+        entity temporary;
+        record( temporary.add<test_value>( 4 ) );
+    }
+    record( values_observer.update_all() );
+    assert_equal( values_observer.get_visited_count(), 1 );
+    assert_equal( values_observer.get_destroyed_count(), 1 );
+
+    record( values_observer.update_all() );
+    assert_equal( values_observer.get_update_count(), 4 );
+}
+
+/* -------------------------------------------------------------------------- */
+/*                               Reflection Info                              */
+/* -------------------------------------------------------------------------- */
+
+namespace reflection
+{
+    auto_reflect_component(, observed_page );
+    auto_reflect_type(, value_observer );
+} // namespace reflection
@@ -0,0 +1,137 @@
+/* *** ** *** ** *** ** *** *
+ * Part of rnjin            *
+ * (c) Rajin Shankar, 2019  *
+ *        rajinshankar.com  *
+ * *** ** *** ** *** ** *** */
+
+#include <rnjin.hpp>
+
+#include "test/module.h"
+#include "ecs/module.h"
+
+#include "test_components.hpp"
+
+using namespace rnjin;
+using namespace rnjin::ecs;
+
+// A sparse component type with a single int step value
+component_class_with_storage( parallel_step, sparse_set )
+{
+    public:
+    parallel_step( int step ) : step( step ) {}
+    ~parallel_step() {}
+
+    public: // accessors
+    let get_step get_value( step );
+
+    private:
+    int step;
+};
+
+// A system that adds steps to values, and totals the steps it applied using per-batch scratch space
+template <typename value_type>
+class parallel_step_system : public rnjin::ecs::system<read_from<parallel_step>, write_to<value_type>>
+{
+    private: // types
+    using base_system       = rnjin::ecs::system<read_from<parallel_step>, write_to<value_type>>;
+    using entity_components = typename base_system::entity_components;
+
+    public: // accessors
+    let get_total get_value( total );
+    let get_batches_seen get_value( batches_seen );
+
+    protected: // inherited
+    void define() override {}
+    void before_update() override
+    {
+        step_totals.reset( this->get_batch_count(), 0 );
+    }
+    void update( entity_components& components ) override
+    {
+        let& step          = components.template readable<parallel_step>();
+        let_mutable& value = components.template writable<value_type>();
+
+        value.add_to_int_value( step.get_step() );
+        step_totals[components.get_batch_index()] += step.get_step();
+    }
+    void after_update() override
+    {
+        total        = 0;
+        batches_seen = step_totals.get_batch_count();
+        for ( usize batch = 0; batch < step_totals.get_batch_count(); batch++ )
+        {
+            total += step_totals[batch];
+        }
+    }
+
+    private: // members
+    batch_scratch<int> step_totals;
+    int total          = 0;
+    usize batches_seen = 0;
+};
+
+test( ecs_parallel_update )
+{
+    worker::pool workers( 3 );
+    parallel_step_system<test_value> stepper;
+
+    list<entity> entities( 100 );
+    for ( usize i = 0; i < entities.size(); i++ )
+    {
+        entities[i].add<test_value>( 0 );
+
+        // Only even entities have a step
+        if ( i % 2 == 0 )
+        {
+            entities[i].add<parallel_step>( 1 );
+        }
+    }
+
+    // 50 steps, split into batches of 8 components of the first (step) type
+    record( stepper.update_all_parallel( 8, workers ) );
+    assert_equal( stepper.get_batches_seen(), 7 );
+    assert_equal( stepper.get_total(), 50 );
+    assert_equal( entities[0].get<test_value>()->get_int_value(), 1 );
+    assert_equal( entities[1].get<test_value>()->get_int_value(), 0 );
+    assert_equal( entities[98].get<test_value>()->get_int_value(), 1 );
+
+    // Serial updates see a single batch
+    record( stepper.update_all() );
+    assert_equal( stepper.get_batches_seen(), 1 );
+    assert_equal( stepper.get_total(), 50 );
+    assert_equal( entities[98].get<test_value>()->get_int_value(), 2 );
+}
+
+test( ecs_parallel_archetype_update )
+{
+    worker::pool workers( 3 );
+    parallel_step_system<test_sparse_value> stepper;
+    archetype<parallel_step, test_sparse_value> stepping;
+
+    list<entity> entities( 30 );
+    for ( usize i = 0; i < entities.size(); i++ )
+    {
+        entities[i].add<test_sparse_value>( 10 );
+        if ( i % 3 == 0 )
+        {
+            entities[i].add<parallel_step>( 2 );
+        }
+    }
+    assert_equal( stepping.get_count(), 10 );
+
+    // Batches split the archetype's packed range, so only the 10 matching entities are counted
+    record( stepper.update_all_parallel( 4, workers ) );
+    assert_equal( stepper.get_batches_seen(), 3 );
+    assert_equal( stepper.get_total(), 20 );
+    assert_equal( entities[3].get<test_sparse_value>()->get_int_value(), 12 );
+    assert_equal( entities[4].get<test_sparse_value>()->get_int_value(), 10 );
+}
+
+/* -------------------------------------------------------------------------- */
+/*                               Reflection Info                              */
+/* -------------------------------------------------------------------------- */
+
+namespace reflection
+{
+    auto_reflect_component(, parallel_step );
+} // namespace reflection
@@ -0,0 +1,144 @@
+/* *** ** *** ** *** ** *** *
+ * Part of rnjin            *
+ * (c) Rajin Shankar, 2019  *
+ *        rajinshankar.com  *
+ * *** ** *** ** *** ** *** */
+
+#include <rnjin.hpp>
+
+#include <mutex>
+
+#include "test/module.h"
+#include "ecs/module.h"
+
+using namespace rnjin;
+using namespace rnjin::ecs;
+
+component_class( scheduled_a ) {};
+component_class( scheduled_b ) {};
+component_class( scheduled_c ) {};
+
+// Names of systems in the order they updated
+static list<string> update_log;
+static std::mutex update_log_lock;
+
+// A system that adds its name to the update log when it updates
+template <typename... accessor_types>
+class logged_system : public rnjin::ecs::system<accessor_types...>
+{
+    private: // types
+    using entity_components = typename rnjin::ecs::system<accessor_types...>::entity_components;
+
+    public: // methods
+    logged_system( const string& name ) : pass_member( name ) {}
+
+    protected: // inherited
+    void define() override {}
+    void update( entity_components& components ) override {}
+    void before_update() override
+    {
+        std::lock_guard<std::mutex> lock( update_log_lock );
+        update_log.push_back( name );
+    }
+
+    private: // members
+    string name;
+};
+
+using a_writer  = logged_system<write_to<scheduled_a>>;
+using b_reader  = logged_system<read_from<scheduled_b>>;
+using ab_system = logged_system<read_from<scheduled_a>, write_to<scheduled_b>>;
+
+// A system that doesn't conflict with any others, but explicitly depends on b_reader
+class c_writer : public logged_system<write_to<scheduled_c>>
+{
+    public: // methods
+    c_writer() : logged_system( "c" ) {}
+
+    protected: // inherited
+    void define() override
+    {
+        depends_on<b_reader>();
+    }
+};
+
+// Get the position of a system in the update log
+static usize update_position( const string& name )
+{
+    return std::find( update_log.begin(), update_log.end(), name ) - update_log.begin();
+}
+
+test( ecs_scheduler_order )
+{
+    worker::pool workers( 0 );
+    scheduler frame( workers );
+
+    c_writer c;
+    b_reader b( "b" );
+    a_writer a( "a" );
+    ab_system ab( "ab" );
+
+    record( frame.add( c ) );
+    record( frame.add( b ) );
+    record( frame.add( a ) );
+    record( frame.add( ab ) );
+    assert_equal( frame.get_system_count(), 4 );
+
+    // c waits for b (explicit), and ab waits for b and a (conflicting, added later)
+    record( update_log.clear() );
+    record( frame.update_all() );
+    assert_equal( update_log.size(), 4 );
+    assert_equal( update_log[0], "b" );
+    assert_equal( update_log[1], "a" );
+    assert_equal( update_log[2], "c" );
+    assert_equal( update_log[3], "ab" );
+
+    // Removed systems no longer update
+    record( frame.remove( c ) );
+    record( update_log.clear() );
+    record( frame.update_all() );
+    assert_equal( update_log.size(), 3 );
+    assert_equal( update_position( "c" ), 3 );
+}
+
+test( ecs_scheduler_parallel )
+{
+    worker::pool workers( 3 );
+    scheduler frame( workers );
+
+    c_writer c;
+    b_reader b( "b" );
+    a_writer a( "a" );
+    ab_system ab( "ab" );
+
+    record( frame.add( c ) );
+    record( frame.add( b ) );
+    record( frame.add( a ) );
+    record( frame.add( ab ) );
+
+    for ( usize i = 0; i < 20; i++ )
+    {
+        update_log.clear();
+        frame.update_all();
+
+        // Independent systems can update in any order, but dependencies are always respected
+        assert_equal( update_log.size(), 4 );
+        assert_equal( update_position( "b" ) < update_position( "c" ), true );
+        assert_equal( update_position( "b" ) < update_position( "ab" ), true );
+        assert_equal( update_position( "a" ) < update_position( "ab" ), true );
+    }
+
+    // No chain of systems can take longer than the whole frame
+    assert_equal( frame.get_critical_path_time() <= frame.get_frame_time(), true );
+}
+
+/* -------------------------------------------------------------------------- */
+/*                               Reflection Info                              */
+/* -------------------------------------------------------------------------- */
+
+namespace reflection
+{
+    auto_reflect_component(, scheduled_a );
+    auto_reflect_component(, scheduled_b );
+    auto_reflect_component(, scheduled_c );
+} // namespace reflection
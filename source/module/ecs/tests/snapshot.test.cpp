@@ -0,0 +1,129 @@
+/* *** ** *** ** *** ** *** *
+ * Part of rnjin            *
+ * (c) Rajin Shankar, 2019  *
+ *        rajinshankar.com  *
+ * *** ** *** ** *** ** *** */
+
+#include <rnjin.hpp>
+
+#include "test/module.h"
+#include "file/module.h"
+#include "ecs/module.h"
+
+using namespace rnjin;
+using namespace rnjin::ecs;
+
+// A sorted, trivially copyable component type with a position in two dimensions
+component_class( snapshot_position )
+{
+    public:
+    snapshot_position( float x, float y ) : x( x ), y( y ) {}
+
+    public: // members
+    float x, y;
+};
+
+// A sparse, trivially copyable component type with a speed
+component_class_with_storage( snapshot_speed, sparse_set )
+{
+    public:
+    snapshot_speed( float speed ) : speed( speed ) {}
+
+    public: // members
+    float speed;
+};
+
+using position_snapshot = snapshot<snapshot_position, snapshot_speed>;
+
+// Counts components added and removed in a single world
+class snapshot_event_counter : public event_receiver
+{
+    public:
+    snapshot_event_counter( world& target )
+    {
+        handle_event( snapshot_position::get_events( target ).added(), &snapshot_event_counter::on_position_added );
+        handle_event( snapshot_position::get_events( target ).removed(), &snapshot_event_counter::on_position_removed );
+    }
+
+    void on_position_added( snapshot_position& position, entity& owner )
+    {
+        event_count += 1;
+    }
+    void on_position_removed( const snapshot_position& position, entity& owner )
+    {
+        event_count += 1;
+    }
+
+    public: // members
+    int event_count = 0;
+};
+
+test( ecs_snapshot_restore )
+{
+    world snapshot_world;
+    world_scope scope( snapshot_world );
+
+    entity_batch batch( 100 );
+    record( batch.add_each<snapshot_position>( []( const usize index ) { return snapshot_position( float( index ), 1.0f ); } ) );
+    for ( usize i = 0; i < batch.get_count(); i += 2 )
+    {
+        batch[i].add<snapshot_speed>( float( i ) );
+    }
+
+    subregion
+    {
+        io::file checkpoint( "test/ecs_snapshot", io::file::mode::write );
+        record( position_snapshot::write( checkpoint ) );
+    }
+
+    // Change every kind of state the snapshot covers
+    snapshot_event_counter counter( snapshot_world );
+    batch[3].get_mutable<snapshot_position>()->x = -1.0f;
+    record( batch[4].remove<snapshot_position>() );
+    record( batch[6].remove<snapshot_speed>() );
+    record( batch[7].add<snapshot_speed>( 7.0f ) );
+    assert_equal( counter.event_count, 1 );
+
+    subregion
+    {
+        io::file checkpoint( "test/ecs_snapshot", io::file::mode::read );
+        record( position_snapshot::read( checkpoint ) );
+    }
+
+    // Restoring sends no events, and signatures follow the restored components
+    assert_equal( counter.event_count, 1 );
+    assert_equal( batch[3].get<snapshot_position>()->x, 3.0f );
+    assert_equal( batch[4].has<snapshot_position>(), true );
+    assert_equal( batch[4].get<snapshot_position>()->y, 1.0f );
+    assert_equal( &batch[4].get<snapshot_position>()->get_owner() == &batch[4], true );
+    assert_equal( batch[6].get<snapshot_speed>()->speed, 6.0f );
+    assert_equal( batch[7].has<snapshot_speed>(), false );
+    assert_equal( batch[7].get<snapshot_speed>() == nullptr, true );
+    assert_equal( snapshot_position::get_owned_component_count(), 100 );
+
+    // Components of entities destroyed since the snapshot was written are skipped
+    subregion
+    {
+        entity temporary;
+        record( temporary.add<snapshot_position>( 0.0f, 0.0f ) );
+        io::file checkpoint( "test/ecs_snapshot_temporary", io::file::mode::write );
+        record( position_snapshot::write( checkpoint ) );
+    }
+    subregion
+    {
+        io::file checkpoint( "test/ecs_snapshot_temporary", io::file::mode::read );
+        record( position_snapshot::read( checkpoint ) );
+    }
+    assert_equal( snapshot_position::get_owned_component_count(), 100 );
+}
+
+/* -------------------------------------------------------------------------- */
+/*                               Reflection Info                              */
+/* -------------------------------------------------------------------------- */
+
+namespace reflection
+{
+    auto_reflect_component(, snapshot_position );
+    auto_reflect_component(, snapshot_speed );
+    auto_reflect_type(, snapshot_event_counter );
+} // namespace reflection
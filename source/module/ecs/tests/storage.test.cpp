@@ -0,0 +1,236 @@
+/* *** ** *** ** *** ** *** *
+ * Part of rnjin            *
+ * (c) Rajin Shankar, 2019  *
+ *        rajinshankar.com  *
+ * *** ** *** ** *** ** *** */
+
+#include <rnjin.hpp>
+
+#include "test/module.h"
+#include "ecs/module.h"
+
+using namespace rnjin;
+using namespace rnjin::ecs;
+
+// A component type stored in a sparse set, with a single int value
+component_class_with_storage( sparse_int_component, sparse_set )
+{
+    public:
+    sparse_int_component( int value ) : value( value ) {}
+    ~sparse_int_component() {}
+
+    void add_to_int_value( int amount )
+    {
+        value += amount;
+    }
+
+    public: // accessors
+    let get_int_value get_value( value );
+
+    private:
+    int value;
+};
+
+// A component type stored sorted by owner (default), with a single int value
+component_class( sorted_int_component )
+{
+    public:
+    sorted_int_component( int value ) : value( value ) {}
+    ~sorted_int_component() {}
+
+    void add_to_int_value( int amount )
+    {
+        value += amount;
+    }
+
+    public: // accessors
+    let get_int_value get_value( value );
+
+    private:
+    int value;
+};
+
+// A component type stored in pages, with a single int value
+component_class_with_storage( paged_int_component, paged )
+{
+    public:
+    paged_int_component( int value ) : value( value ) {}
+    ~paged_int_component() {}
+
+    public: // accessors
+    let get_int_value get_value( value );
+
+    private:
+    int value;
+};
+
+// A system that adds a sparse component's value to a sorted component's value
+class sparse_to_sorted_system : public rnjin::ecs::system<read_from<sparse_int_component>, write_to<sorted_int_component>>
+{
+    protected: // inherited
+    void define() override {}
+    void update( entity_components& components ) override
+    {
+        let& source         = components.readable<sparse_int_component>();
+        let_mutable& target = components.writable<sorted_int_component>();
+
+        target.add_to_int_value( source.get_int_value() );
+    }
+};
+
+// A system that adds a sorted component's value to a sparse component's value
+class sorted_to_sparse_system : public rnjin::ecs::system<read_from<sorted_int_component>, write_to<sparse_int_component>>
+{
+    protected: // inherited
+    void define() override {}
+    void update( entity_components& components ) override
+    {
+        let& source         = components.readable<sorted_int_component>();
+        let_mutable& target = components.writable<sparse_int_component>();
+
+        target.add_to_int_value( source.get_int_value() );
+    }
+};
+
+// A system that adds a paged component's value to a sorted component's value
+class paged_to_sorted_system : public rnjin::ecs::system<read_from<paged_int_component>, write_to<sorted_int_component>>
+{
+    protected: // inherited
+    void define() override {}
+    void update( entity_components& components ) override
+    {
+        let& source         = components.readable<paged_int_component>();
+        let_mutable& target = components.writable<sorted_int_component>();
+
+        target.add_to_int_value( source.get_int_value() );
+    }
+};
+
+test( ecs_sparse_set_storage )
+{
+    entity ent1, ent2, ent3, ent4;
+
+    // Components are appended regardless of owner order
+    record( ent3.add<sparse_int_component>( 3 ) );
+    record( ent1.add<sparse_int_component>( 1 ) );
+    record( ent4.add<sparse_int_component>( 4 ) );
+    record( ent2.add<sparse_int_component>( 2 ) );
+
+    assert_equal( ent1.get<sparse_int_component>()->get_int_value(), 1 );
+    assert_equal( ent2.get<sparse_int_component>()->get_int_value(), 2 );
+    assert_equal( ent3.get<sparse_int_component>()->get_int_value(), 3 );
+    assert_equal( ent4.get<sparse_int_component>()->get_int_value(), 4 );
+
+    // Removing from the middle moves the last component (ent2's) into the removed slot
+    record( ent1.remove<sparse_int_component>() );
+
+    assert_equal( ent1.get<sparse_int_component>() == nullptr, true );
+    assert_equal( ent2.get<sparse_int_component>()->get_int_value(), 2 );
+    assert_equal( ent3.get<sparse_int_component>()->get_int_value(), 3 );
+    assert_equal( ent4.get<sparse_int_component>()->get_int_value(), 4 );
+
+    // Owners keep the same component after being moved
+    assert_equal( &ent2.get<sparse_int_component>()->get_owner() == &ent2, true );
+
+    // Components can be re-added after removal
+    record( ent1.add<sparse_int_component>( 10 ) );
+    assert_equal( ent1.get<sparse_int_component>()->get_int_value(), 10 );
+}
+
+test( ecs_mixed_storage_systems )
+{
+    entity ent1, ent2, ent3, ent4;
+    sparse_to_sorted_system sparse_to_sorted;
+    sorted_to_sparse_system sorted_to_sparse;
+
+    record( ent4.add<sparse_int_component>( 4 ) );
+    record( ent2.add<sparse_int_component>( 2 ) );
+    record( ent1.add<sparse_int_component>( 1 ) );
+
+    record( ent1.add<sorted_int_component>( 100 ) );
+    record( ent3.add<sorted_int_component>( 300 ) );
+    record( ent4.add<sorted_int_component>( 400 ) );
+
+    // Only ent1 and ent4 own both component types
+    record( sparse_to_sorted.update_all() );
+    assert_equal( ent1.get<sorted_int_component>()->get_int_value(), 101 );
+    assert_equal( ent3.get<sorted_int_component>()->get_int_value(), 300 );
+    assert_equal( ent4.get<sorted_int_component>()->get_int_value(), 404 );
+
+    record( sorted_to_sparse.update_all() );
+    assert_equal( ent1.get<sparse_int_component>()->get_int_value(), 102 );
+    assert_equal( ent2.get<sparse_int_component>()->get_int_value(), 2 );
+    assert_equal( ent4.get<sparse_int_component>()->get_int_value(), 408 );
+}
+
+test( ecs_sparse_set_references )
+{
+    entity ent1, ent2, ent3, ent4;
+
+    record( ent1.add<sparse_int_component>( 1 ) );
+    record( ent2.add<sparse_int_component>( 2 ) );
+    record( ent3.add<sparse_int_component>( 3 ) );
+
+    record( ent4.add<sparse_int_component::reference>( &ent3 ) );
+    assert_equal( ent4.get<sparse_int_component::reference>()->get_pointer()->get_int_value(), 3 );
+
+    // ent3's component is moved into ent1's slot, and the reference should follow it
+    record( ent1.remove<sparse_int_component>() );
+    assert_equal( ent4.get<sparse_int_component::reference>()->get_pointer()->get_int_value(), 3 );
+    assert_equal( &ent4.get<sparse_int_component::reference>()->get_referenced_owner() == &ent3, true );
+}
+
+test( ecs_paged_storage )
+{
+    entity ent1, ent2, ent3;
+
+    record( ent1.add<paged_int_component>( 1 ) );
+    record( ent2.add<paged_int_component>( 2 ) );
+    record( ent3.add<paged_int_component>( 3 ) );
+    const paged_int_component* first  = ent1.get<paged_int_component>();
+    const paged_int_component* second = ent2.get<paged_int_component>();
+    const paged_int_component* third  = ent3.get<paged_int_component>();
+
+    // Growing past the first page never moves existing components
+    entity_batch batch( 3 * paged_int_component::page_size );
+    record( batch.add_each<paged_int_component>( []( const usize index ) { return paged_int_component( int( index ) ); } ) );
+    assert_equal( ent1.get<paged_int_component>() == first, true );
+    assert_equal( ent3.get<paged_int_component>() == third, true );
+    assert_equal( batch[2500].get<paged_int_component>()->get_int_value(), 2500 );
+
+    // Removing a component leaves a vacancy rather than moving others, which the next addition reuses
+    record( ent2.remove<paged_int_component>() );
+    assert_equal( ent3.get<paged_int_component>() == third, true );
+    assert_equal( ent3.get<paged_int_component>()->get_int_value(), 3 );
+
+    entity ent4;
+    record( ent4.add<paged_int_component>( 4 ) );
+    assert_equal( ent4.get<paged_int_component>() == second, true );
+    assert_equal( &ent4.get<paged_int_component>()->get_owner() == &ent4, true );
+
+    // Systems skip vacancies
+    record( ent1.remove<paged_int_component>() );
+    record( ent1.add<sorted_int_component>( 100 ) );
+    record( ent2.add<sorted_int_component>( 200 ) );
+    record( ent3.add<sorted_int_component>( 300 ) );
+    record( ent4.add<sorted_int_component>( 400 ) );
+
+    paged_to_sorted_system paged_to_sorted;
+    record( paged_to_sorted.update_all() );
+    assert_equal( ent1.get<sorted_int_component>()->get_int_value(), 100 );
+    assert_equal( ent2.get<sorted_int_component>()->get_int_value(), 200 );
+    assert_equal( ent3.get<sorted_int_component>()->get_int_value(), 303 );
+    assert_equal( ent4.get<sorted_int_component>()->get_int_value(), 404 );
+}
+
+/* -------------------------------------------------------------------------- */
+/*                               Reflection Info                              */
+/* -------------------------------------------------------------------------- */
+
+namespace reflection
+{
+    auto_reflect_component(, sparse_int_component );
+    auto_reflect_component(, sorted_int_component );
+    auto_reflect_component(, paged_int_component );
+    auto_reflect_type(, paged_to_sorted_system );
+} // namespace reflection
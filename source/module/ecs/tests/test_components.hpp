@@ -0,0 +1,70 @@
+/* *** ** *** ** *** ** *** *
+ * Part of rnjin            *
+ * (c) Rajin Shankar, 2019  *
+ *        rajinshankar.com  *
+ * *** ** *** ** *** ** *** */
+
+#pragma once
+#include <rnjin.hpp>
+
+#include "ecs/module.h"
+#include "reflection/module.h"
+
+// Component types shared by the ecs tests
+// note: each test destroys its entities before it ends, so tests never see each other's components
+
+// A sorted component type with a single int value
+component_class( test_value )
+{
+    public:
+    test_value( int value ) : value( value ) {}
+    ~test_value() {}
+
+    void set_int_value( int new_value )
+    {
+        value = new_value;
+    }
+    void add_to_int_value( int amount )
+    {
+        value += amount;
+    }
+
+    public: // accessors
+    let get_int_value get_value( value );
+
+    private:
+    int value;
+};
+
+// A sparse component type with a single int value
+component_class_with_storage( test_sparse_value, sparse_set )
+{
+    public:
+    test_sparse_value( int value ) : value( value ) {}
+    ~test_sparse_value() {}
+
+    void set_int_value( int new_value )
+    {
+        value = new_value;
+    }
+    void add_to_int_value( int amount )
+    {
+        value += amount;
+    }
+
+    public: // accessors
+    let get_int_value get_value( value );
+
+    private:
+    int value;
+};
+
+/* -------------------------------------------------------------------------- */
+/*                               Reflection Info                              */
+/* -------------------------------------------------------------------------- */
+
+namespace reflection
+{
+    auto_reflect_component(, test_value );
+    auto_reflect_component(, test_sparse_value );
+} // namespace reflection
@@ -0,0 +1,161 @@
+/* *** ** *** ** *** ** *** *
+ * Part of rnjin            *
+ * (c) Rajin Shankar, 2019  *
+ *        rajinshankar.com  *
+ * *** ** *** ** *** ** *** */
+
+#include <rnjin.hpp>
+
+#include <memory>
+#include <thread>
+
+#include "test/module.h"
+#include "ecs/module.h"
+
+#include "test_components.hpp"
+
+using namespace rnjin;
+using namespace rnjin::ecs;
+
+// A sparse component type with a single int step value
+component_class_with_storage( world_step, sparse_set )
+{
+    public:
+    world_step( int step ) : step( step ) {}
+    ~world_step() {}
+
+    public: // members
+    int step;
+};
+
+// Adds each entity's step to its value
+class world_stepper : public rnjin::ecs::system<write_to<test_value>, read_from<world_step>>
+{
+    public: // accessors
+    let get_update_count get_value( update_count );
+
+    protected: // inherited
+    void define() override {}
+    void update( entity_components& components ) override
+    {
+        components.writable<test_value>().add_to_int_value( components.readable<world_step>().step );
+        update_count += 1;
+    }
+
+    private: // members
+    usize update_count = 0;
+};
+
+// Counts components added in a single world
+class world_value_counter : public event_receiver
+{
+    public:
+    world_value_counter( world& target )
+    {
+        handle_event( test_value::get_events( target ).added(), &world_value_counter::on_value_added );
+    }
+
+    void on_value_added( test_value& value, entity& owner )
+    {
+        added_count += 1;
+    }
+
+    public: // members
+    int added_count = 0;
+};
+
+// Build a world of entities with values and steps, step it a number of times, and get the sum of its values
+int run_world( world& target, const usize entity_count, const int step, const usize update_count )
+{
+    world_scope scope( target );
+
+    entity_batch batch( entity_count );
+    batch.add<test_value>( 0 );
+    batch.add<world_step>( step );
+
+    world_stepper stepper;
+    for ( usize i = 0; i < update_count; i++ )
+    {
+        stepper.update_all();
+    }
+
+    int sum = 0;
+    for ( usize i = 0; i < batch.get_count(); i++ )
+    {
+        sum += batch[i].get<test_value>()->get_int_value();
+    }
+    return sum;
+}
+
+test( ecs_world_isolation )
+{
+    world first_world, second_world;
+
+    // Entities in different worlds can share ids, but not components
+    entity first( first_world ), second( second_world );
+    assert_equal( first.get_id() == second.get_id(), true );
+    record( first.add<test_value>( 1 ) );
+    assert_equal( first.get<test_value>()->get_int_value(), 1 );
+    assert_equal( second.get<test_value>() == nullptr, true );
+    assert_equal( first.has<test_value>(), true );
+    assert_equal( second.has<test_value>(), false );
+
+    record( second.add<test_value>( 2 ) );
+    record( second.add<world_step>( 10 ) );
+    assert_equal( first.get<test_value>()->get_int_value(), 1 );
+
+    // Systems only visit the world they were created in
+    std::unique_ptr<world_stepper> second_stepper;
+    {
+        world_scope scope( second_world );
+        second_stepper.reset( new world_stepper() );
+        assert_equal( entity::is_alive( second.get_id() ), true );
+    }
+    record( first.add<world_step>( 100 ) );
+    record( second_stepper->update_all() );
+    assert_equal( second_stepper->get_update_count(), 1 );
+    assert_equal( first.get<test_value>()->get_int_value(), 1 );
+    assert_equal( second.get<test_value>()->get_int_value(), 12 );
+
+    // Each world has its own events
+    world_value_counter first_counter( first_world ), second_counter( second_world );
+    entity third( second_world );
+    record( third.add<test_value>( 3 ) );
+    assert_equal( first_counter.added_count, 0 );
+    assert_equal( second_counter.added_count, 1 );
+}
+
+test( ecs_world_concurrent_updates )
+{
+    const usize entity_count = 2000;
+    const usize update_count = 50;
+
+    // Worlds share no mutable state, so they can be updated on separate threads at once
+    world worlds[4];
+    int sums[4] = { 0, 0, 0, 0 };
+    list<std::thread> threads;
+    for ( int i = 0; i < 4; i++ )
+    {
+        threads.emplace_back( [&, i] { sums[i] = run_world( worlds[i], entity_count, i + 1, update_count ); } );
+    }
+    for ( std::thread& thread : threads )
+    {
+        thread.join();
+    }
+
+    for ( int i = 0; i < 4; i++ )
+    {
+        assert_equal( sums[i], int( entity_count * update_count ) * ( i + 1 ) );
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/*                               Reflection Info                              */
+/* -------------------------------------------------------------------------- */
+
+namespace reflection
+{
+    auto_reflect_component(, world_step );
+    auto_reflect_type(, world_stepper );
+    auto_reflect_type(, world_value_counter );
+} // namespace reflection
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "graphics/ecs/public/model.hpp"
+#include "graphics/ecs/public/scene_hierarchy.hpp"
 #include "graphics/ecs/public/render_view_collector.hpp"
 
 #include "graphics/ecs/public/ecs_resources.hpp"
\ No newline at end of file
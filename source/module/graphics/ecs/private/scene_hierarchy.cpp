@@ -0,0 +1,251 @@
+/* *** ** *** ** *** ** *** *
+ * Part of rnjin            *
+ * (c) Rajin Shankar, 2019  *
+ *        rajinshankar.com  *
+ * *** ** *** ** *** ** *** */
+
+#include "scene_hierarchy.hpp"
+
+#include <algorithm>
+
+#include "graphics/public/common.hpp"
+
+namespace rnjin::graphics
+{
+    scene_hierarchy::scene_hierarchy()
+      : target_world( ecs::world::get_current() ), //
+        level_starts( 1, 0 ),                      //
+        needs_rebuild( true ),                     //
+        last_update_tick( 0 ),                     //
+        updated_count( 0 )                         //
+    {
+        handle_event( scene_node::get_events( target_world ).added_batch(), &scene_hierarchy::on_nodes_added );
+        handle_event( scene_node::get_events( target_world ).removed_batch(), &scene_hierarchy::on_nodes_removed );
+    }
+    scene_hierarchy::~scene_hierarchy() {}
+
+    void scene_hierarchy::update( worker::pool& workers )
+    {
+        ecs::world_scope scope( target_world );
+        let update_tick = target_world.advance_change_tick();
+
+        // Nothing needs to be computed if no node has changed
+        // note: rebuilding flags every node, since any of them could have moved
+        bool any_changed = needs_rebuild or find_changes();
+        if ( needs_rebuild )
+        {
+            rebuild();
+            needs_rebuild = false;
+        }
+
+        updated_count = 0;
+        if ( any_changed )
+        {
+            // Each depth only reads world matrices computed at the depth before it
+            for ( usize depth = 0; depth < get_depth_count(); depth++ )
+            {
+                let first = level_starts[depth];
+                let last  = level_starts[depth + 1];
+                if ( last - first <= batch_size )
+                {
+                    updated_count += update_range( first, last );
+                    continue;
+                }
+
+                list<usize> batch_updated_counts( ( last - first + batch_size - 1 ) / batch_size, 0 );
+                workers.run_all( batch_updated_counts.size(), [&]( const usize batch_index ) {
+                    let batch_first                   = first + batch_index * batch_size;
+                    batch_updated_counts[batch_index] = update_range( batch_first, std::min( batch_first + batch_size, last ) );
+                } );
+                foreach ( batch_updated_count : batch_updated_counts )
+                {
+                    updated_count += batch_updated_count;
+                }
+            }
+
+            std::fill( dirty.begin(), dirty.end(), byte( 0 ) );
+        }
+
+        last_update_tick = update_tick;
+    }
+
+    void scene_hierarchy::on_nodes_added( const scene_node::added_span& added )
+    {
+        needs_rebuild = true;
+    }
+    void scene_hierarchy::on_nodes_removed( const scene_node::removed_span& removed )
+    {
+        // note: the removed nodes are still in the arrays, but they're only used again after rebuilding
+        needs_rebuild = true;
+    }
+
+    void scene_hierarchy::rebuild()
+    {
+        static constexpr usize no_parent = scene_node::invalid_index;
+
+        // Gather every node, numbering them in the order they're stored in
+        list<scene_node*> gathered;
+        let_mutable all_nodes = scene_node::get_mutable_iterator();
+        while ( all_nodes.is_valid() )
+        {
+            let_mutable& node      = ( *all_nodes ).component_data;
+            node.hierarchy_index   = gathered.size();
+            node.parent_changed    = false;
+            gathered.push_back( &node );
+            all_nodes.advance();
+        }
+
+        // Find each node's parent among them, and group the children of each node together
+        list<usize> gathered_parents( gathered.size(), no_parent );
+        list<usize> child_offsets( gathered.size() + 1, 0 );
+        for ( usize i = 0; i < gathered.size(); i++ )
+        {
+            let* parent_owner = target_world.get_entity( gathered[i]->parent_id );
+            let* parent_node  = parent_owner == nullptr ? nullptr : parent_owner->get<scene_node>();
+            if ( parent_node != nullptr )
+            {
+                gathered_parents[i] = parent_node->hierarchy_index;
+                child_offsets[gathered_parents[i] + 1] += 1;
+            }
+        }
+        for ( usize i = 0; i < gathered.size(); i++ )
+        {
+            child_offsets[i + 1] += child_offsets[i];
+        }
+
+        list<usize> children( child_offsets.back() );
+        list<usize> next_child( child_offsets.begin(), child_offsets.end() - 1 );
+        for ( usize i = 0; i < gathered.size(); i++ )
+        {
+            if ( gathered_parents[i] != no_parent )
+            {
+                children[next_child[gathered_parents[i]]++] = i;
+            }
+        }
+
+        // Visit nodes breadth first from the roots, so each depth ends up contiguous and after its parents' depth
+        list<usize> order;
+        order.reserve( gathered.size() );
+        parent_indices.clear();
+        parent_indices.reserve( gathered.size() );
+        for ( usize i = 0; i < gathered.size(); i++ )
+        {
+            if ( gathered_parents[i] == no_parent )
+            {
+                order.push_back( i );
+                parent_indices.push_back( no_parent );
+            }
+        }
+
+        level_starts.assign( 1, 0 );
+        for ( usize level_first = 0; level_first < order.size(); )
+        {
+            let level_last = order.size();
+            for ( usize position = level_first; position < level_last; position++ )
+            {
+                let parent = order[position];
+                for ( usize child = child_offsets[parent]; child < child_offsets[parent + 1]; child++ )
+                {
+                    order.push_back( children[child] );
+                    parent_indices.push_back( position );
+                }
+            }
+
+            level_starts.push_back( level_last );
+            level_first = level_last;
+        }
+
+        // Nodes whose parents lead back to themselves are never reached from a root
+        check_error_condition( pass, graphics_log_errors, order.size() != gathered.size(), "\1 scene nodes are parented in a cycle, and won't be updated", gathered.size() - order.size() );
+
+        nodes.resize( order.size() );
+        for ( usize position = 0; position < order.size(); position++ )
+        {
+            nodes[position]                  = gathered[order[position]];
+            nodes[position]->hierarchy_index = position;
+        }
+        for ( usize i = 0; i < gathered.size(); i++ )
+        {
+            if ( gathered[i]->hierarchy_index >= order.size() or nodes[gathered[i]->hierarchy_index] != gathered[i] )
+            {
+                gathered[i]->hierarchy_index = scene_node::invalid_index;
+            }
+        }
+
+        world_matrices.resize( nodes.size() );
+        dirty.assign( nodes.size(), byte( 1 ) );
+    }
+
+    bool scene_hierarchy::find_changes()
+    {
+        constexpr usize chunk_size = scene_node::change_chunk_size;
+        let_mutable& pages         = scene_node::get_owned_component_pages();
+        bool any_changed           = false;
+
+        for ( usize chunk_first = 0; chunk_first < pages.size(); chunk_first += chunk_size )
+        {
+            // Skip chunks without any nodes changed since the last update
+            if ( scene_node::get_chunk_changed_tick( chunk_first / chunk_size ) <= last_update_tick )
+            {
+                continue;
+            }
+
+            let chunk_last = std::min( chunk_first + chunk_size, pages.size() );
+            for ( usize index = chunk_first; index < chunk_last; index++ )
+            {
+                if ( not pages.is_occupied( index ) or pages[index].get_changed_tick() <= last_update_tick )
+                {
+                    continue;
+                }
+
+                let& node = pages[index].component_data;
+                if ( node.parent_changed )
+                {
+                    needs_rebuild = true;
+                    return true;
+                }
+                if ( node.hierarchy_index != scene_node::invalid_index )
+                {
+                    dirty[node.hierarchy_index] = 1;
+                    any_changed                 = true;
+                }
+            }
+        }
+
+        return any_changed;
+    }
+
+    usize scene_hierarchy::update_range( const usize first, const usize last )
+    {
+        usize computed_count = 0;
+        for ( usize index = first; index < last; index++ )
+        {
+            // Changes to a node move its whole subtree
+            let parent = parent_indices[index];
+            if ( parent != scene_node::invalid_index and dirty[parent] )
+            {
+                dirty[index] = 1;
+            }
+            if ( not dirty[index] )
+            {
+                continue;
+            }
+
+            let_mutable& node     = *nodes[index];
+            let local_matrix      = node.local_transform.get_matrix();
+            world_matrices[index] = parent == scene_node::invalid_index ? local_matrix : world_matrices[parent] * local_matrix;
+            node.world_matrix     = world_matrices[index];
+            computed_count += 1;
+        }
+        return computed_count;
+    }
+} // namespace rnjin::graphics
+
+/* -------------------------------------------------------------------------- */
+/*                               Reflection Info                              */
+/* -------------------------------------------------------------------------- */
+
+namespace reflection
+{
+    auto_reflect_component( rnjin::graphics, scene_node );
+} // namespace reflection
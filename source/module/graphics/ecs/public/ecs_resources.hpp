@@ -106,13 +106,16 @@ namespace rnjin::graphics
         {}
         ~ecs_material() {}
 
+        // note: also marks the material as changed, so collectors filtering on changed<ecs_material> see the new version
         void increment_version()
         {
             version++;
+            mark_changed();
         }
         void increment_instance_data_version()
         {
             instance_data_version++;
+            mark_changed();
         }
 
         public: // types
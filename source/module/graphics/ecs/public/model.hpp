@@ -33,12 +33,6 @@ namespace rnjin::graphics
         private: // members
         mesh mesh_resource;
         material material_resource;
-
-        group
-        {
-            float3 x, y, z;
-        }
-        basis;
     };
 } // namespace rnjin::graphics
 
@@ -14,7 +14,8 @@
 
 namespace rnjin::graphics
 {
-    class render_view_collector : public ecs::system<read_from<model>>
+    // note: a static_system, since it visits every model each frame
+    class render_view_collector : public ecs::static_system<render_view_collector, read_from<model>>
     {
         public: // methods
         render_view_collector( render_view& target_view ) : pass_member( target_view ) {}
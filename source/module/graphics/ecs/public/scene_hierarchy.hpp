@@ -0,0 +1,135 @@
+/* *** ** *** ** *** ** *** *
+ * Part of rnjin            *
+ * (c) Rajin Shankar, 2019  *
+ *        rajinshankar.com  *
+ * *** ** *** ** *** ** *** */
+
+#pragma once
+#include <rnjin.hpp>
+
+#include "ecs/module.h"
+#include "math/module.h"
+#include "worker/module.h"
+
+namespace rnjin::graphics
+{
+    // A node in a scene hierarchy: a transform relative to its parent node (if it has one), and the world matrix that
+    // results from it
+    // ex. `wheel.add<scene_node>( &car );` ... `wheel.get_mutable<scene_node>()->set_rotation( float3( 0, 0, angle ) );`
+    // note: world matrices are computed by a scene_hierarchy, so they're only up to date after its next update, and are
+    //       what material uniforms expect (ex. `model.get_material_mutable().set_world_matrix( node.get_world_matrix() )`)
+    // note: paged, so the hierarchy can keep pointers to nodes between updates
+    class scene_node : public ecs::component<scene_node, ecs::storage_mode::paged>
+    {
+        public: // methods
+        scene_node() : parent_id(), parent_changed( false ), hierarchy_index( invalid_index ) {}
+        scene_node( const ecs::entity* parent ) : parent_id( parent->get_id() ), parent_changed( false ), hierarchy_index( invalid_index ) {}
+
+        // Attach this node below the node of another entity, or detach it to make it a root
+        // note: a parent that doesn't own a scene_node (or is destroyed) leaves this node as a root
+        void set_parent( const ecs::entity& parent )
+        {
+            parent_id      = parent.get_id();
+            parent_changed = true;
+            mark_changed();
+        }
+        void clear_parent()
+        {
+            parent_id      = ecs::entity::id();
+            parent_changed = true;
+            mark_changed();
+        }
+
+        // Change the transform relative to the parent node
+        void set_position( const float3 new_position )
+        {
+            local_transform.set_position( new_position );
+            mark_changed();
+        }
+        void set_rotation( const float3 new_euler_angles )
+        {
+            local_transform.set_rotation( new_euler_angles );
+            mark_changed();
+        }
+        void set_scale( const float3 new_scale )
+        {
+            local_transform.set_scale( new_scale );
+            mark_changed();
+        }
+
+        public: // accessors
+        let get_parent_id get_value( parent_id );
+        let has_parent get_value( parent_id.is_valid() );
+        let& get_local_transform get_value( local_transform );
+        let& get_world_matrix get_value( world_matrix );
+
+        private: // members
+        friend class scene_hierarchy;
+
+        ecs::entity::id parent_id;
+        math::transform local_transform;
+        float4x4 world_matrix;
+
+        // Whether the parent has changed since the hierarchy last sorted its nodes
+        bool parent_changed;
+        // Index in the hierarchy's depth-sorted arrays, as of when it last sorted its nodes
+        usize hierarchy_index;
+    };
+
+    // Computes the world matrices of every scene_node in a world, parents before children
+    // ex. `scene_hierarchy hierarchy;` ... `hierarchy.update();` once each frame, before rendering
+    // note: nodes are kept sorted by depth (breadth first from the roots) in contiguous arrays, which are only rebuilt
+    //       when nodes are added, removed or reparented
+    // note: only the subtrees of nodes changed since the last update are recomputed, and unchanged chunks of nodes are
+    //       skipped using their change ticks, so frames where nothing moved cost O( node_count / change_chunk_size )
+    // note: nodes at the same depth never depend on each other, so each depth is computed in parallel on a worker pool
+    class scene_hierarchy : public event_receiver
+    {
+        public: // methods
+        // Track the nodes of the world that's current on this thread
+        scene_hierarchy();
+        ~scene_hierarchy();
+        no_copy( scene_hierarchy );
+
+        // Recompute the world matrices of changed nodes and their descendants
+        void update( worker::pool& workers = worker::pool::get_default() );
+
+        public: // accessors
+        let get_node_count get_value( nodes.size() );
+        let get_depth_count get_value( level_starts.size() - 1 );
+        // Number of nodes whose world matrices were recomputed by the last update
+        let get_updated_count get_value( updated_count );
+
+        public: // constants
+        // Number of nodes at the same depth computed by each job, so small depths are computed on the calling thread
+        static constexpr usize batch_size = 1024;
+
+        private: // methods
+        void on_nodes_added( const scene_node::added_span& added );
+        void on_nodes_removed( const scene_node::removed_span& removed );
+
+        // Sort every node by depth, breadth first from the roots, and flag all of them to be recomputed
+        void rebuild();
+        // Flag nodes changed since the last update (or that the hierarchy needs to be rebuilt), returning whether any were
+        bool find_changes();
+        // Compute the world matrices of flagged nodes (and nodes with flagged parents) in [first, last) of the arrays,
+        // returning the number computed
+        usize update_range( const usize first, const usize last );
+
+        private: // members
+        ecs::world& target_world;
+
+        // Per-node data, sorted by depth
+        list<scene_node*> nodes;
+        list<usize> parent_indices;
+        list<float4x4> world_matrices;
+        // note: bytes rather than bools, so nodes at the same depth can be flagged from different threads
+        list<byte> dirty;
+        // Index of the first node at each depth, followed by the number of nodes
+        list<usize> level_starts;
+
+        bool needs_rebuild;
+        ecs::change_tick last_update_tick;
+        usize updated_count;
+    };
+} // namespace rnjin::graphics
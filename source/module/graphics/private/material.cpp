@@ -27,6 +27,12 @@ namespace rnjin::graphics
     {}
     material::~material() {}
 
+    void material::set_world_matrix( const float4x4& matrix )
+    {
+        uniforms_version++;
+        uniforms.world_matrix = matrix;
+    }
+
     void material::set_position( float3 position )
     {
         uniforms_version++;
@@ -20,6 +20,9 @@ namespace rnjin::graphics
         material( const string& name, const shader& vertex_shader, const shader& fragment_shader );
         ~material();
 
+        // Set the transformation from object space to world space (ex. a scene_node's world matrix)
+        void set_world_matrix( const float4x4& matrix );
+
         // test methods
         void set_position( float3 position );
         void set_rotation_and_scale( float3 euler_angles, float3 scale );
@@ -0,0 +1,112 @@
+/* *** ** *** ** *** ** *** *
+ * Part of rnjin            *
+ * (c) Rajin Shankar, 2019  *
+ *        rajinshankar.com  *
+ * *** ** *** ** *** ** *** */
+
+#include <rnjin.hpp>
+
+#include "test/module.h"
+
+#include "ecs/module.h"
+#include "math/module.h"
+#include "graphics/ecs.h"
+
+using namespace rnjin;
+using namespace rnjin::ecs;
+using namespace rnjin::graphics;
+
+// Get the world position of a node's origin
+static float4 get_world_origin( const entity& owner )
+{
+    return owner.get<scene_node>()->get_world_matrix() * float4( 0, 0, 0, 1 );
+}
+
+test( scene_hierarchy )
+{
+    world test_world;
+    world_scope scope( test_world );
+
+    entity root, child, grandchild, other_root;
+    record( root.add<scene_node>() );
+    record( child.add<scene_node>( &root ) );
+    record( grandchild.add<scene_node>( &child ) );
+    record( other_root.add<scene_node>() );
+
+    record( root.get_mutable<scene_node>()->set_position( float3( 1, 0, 0 ) ) );
+    record( child.get_mutable<scene_node>()->set_position( float3( 0, 2, 0 ) ) );
+    record( grandchild.get_mutable<scene_node>()->set_position( float3( 0, 0, 3 ) ) );
+    record( other_root.get_mutable<scene_node>()->set_position( float3( 5, 5, 5 ) ) );
+
+    scene_hierarchy hierarchy;
+
+    note( "Initial Update" );
+    record( hierarchy.update() );
+    assert_equal( hierarchy.get_node_count(), 4 );
+    assert_equal( hierarchy.get_depth_count(), 3 );
+    assert_equal( hierarchy.get_updated_count(), 4 );
+    assert_equal( get_world_origin( root ), float4( 1, 0, 0, 1 ) );
+    assert_equal( get_world_origin( child ), float4( 1, 2, 0, 1 ) );
+    assert_equal( get_world_origin( grandchild ), float4( 1, 2, 3, 1 ) );
+    assert_equal( get_world_origin( other_root ), float4( 5, 5, 5, 1 ) );
+
+    note( "Unchanged Update" );
+    record( hierarchy.update() );
+    assert_equal( hierarchy.get_updated_count(), 0 );
+
+    note( "Moving a Node Updates its Subtree" );
+    record( child.get_mutable<scene_node>()->set_position( float3( 0, 4, 0 ) ) );
+    record( hierarchy.update() );
+    assert_equal( hierarchy.get_updated_count(), 2 );
+    assert_equal( get_world_origin( child ), float4( 1, 4, 0, 1 ) );
+    assert_equal( get_world_origin( grandchild ), float4( 1, 4, 3, 1 ) );
+    assert_equal( get_world_origin( root ), float4( 1, 0, 0, 1 ) );
+
+    note( "Reparenting" );
+    record( grandchild.get_mutable<scene_node>()->set_parent( other_root ) );
+    record( hierarchy.update() );
+    assert_equal( hierarchy.get_depth_count(), 2 );
+    assert_equal( get_world_origin( grandchild ), float4( 5, 5, 8, 1 ) );
+
+    record( grandchild.get_mutable<scene_node>()->clear_parent() );
+    record( hierarchy.update() );
+    assert_equal( get_world_origin( grandchild ), float4( 0, 0, 3, 1 ) );
+
+    note( "Removing a Parent" );
+    record( grandchild.get_mutable<scene_node>()->set_parent( child ) );
+    record( root.remove<scene_node>() );
+    record( hierarchy.update() );
+    assert_equal( hierarchy.get_node_count(), 3 );
+    assert_equal( get_world_origin( child ), float4( 0, 4, 0, 1 ) );
+    assert_equal( get_world_origin( grandchild ), float4( 0, 4, 3, 1 ) );
+}
+
+test( scene_hierarchy_parallel )
+{
+    world test_world;
+    world_scope scope( test_world );
+
+    // Enough children of a single root to be split into several jobs
+    const usize child_count = scene_hierarchy::batch_size * 3 + 10;
+    entity root;
+    record( root.add<scene_node>() );
+    record( root.get_mutable<scene_node>()->set_position( float3( 0, 1, 0 ) ) );
+
+    entity_batch children( child_count );
+    record( children.add_each<scene_node>( [&]( const usize index ) { return scene_node( &root ); } ) );
+    for ( usize i = 0; i < child_count; i++ )
+    {
+        children[i].get_mutable<scene_node>()->set_position( float3( (float) i, 0, 0 ) );
+    }
+
+    scene_hierarchy hierarchy;
+    record( hierarchy.update() );
+    assert_equal( hierarchy.get_updated_count(), child_count + 1 );
+    assert_equal( get_world_origin( children[child_count - 1] ), float4( (float) ( child_count - 1 ), 1, 0, 1 ) );
+
+    // Moving the root moves every child
+    record( root.get_mutable<scene_node>()->set_position( float3( 0, 2, 0 ) ) );
+    record( hierarchy.update() );
+    assert_equal( hierarchy.get_updated_count(), child_count + 1 );
+    assert_equal( get_world_origin( children[100] ), float4( 100, 2, 0, 1 ) );
+}
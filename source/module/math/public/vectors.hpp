@@ -232,7 +232,7 @@ namespace rnjin::core
         {}
         float4 rows[4];
 
-        inline float4 operator*( const float4 other )
+        inline float4 operator*( const float4 other ) const
         {
             return float4(
                 rows[0] * other, //
@@ -242,6 +242,18 @@ namespace rnjin::core
             );
         }
 
+        // Matrix product, ie. the transformation that applies `other` first, then this one
+        inline float4x4 operator*( const float4x4& other ) const
+        {
+            float4x4 result;
+            for ( uint row = 0; row < 4; row++ )
+            {
+                let& source      = rows[row];
+                result.rows[row] = other.rows[0] * source.x + other.rows[1] * source.y + other.rows[2] * source.z + other.rows[3] * source.w;
+            }
+            return result;
+        }
+
         inline static float4x4 identity()
         {
             return float4x4( float4( 1, 0, 0, 0 ), float4( 0, 1, 0, 0 ), float4( 0, 0, 1, 0 ), float4( 0, 0, 0, 1 ) );
@@ -77,4 +77,12 @@ test( vector_operators )
 test( matrix_operations )
 {
     assert_equal( float4x4() * float4( 1, 2, 3, 4 ), float4( 1, 2, 3, 4 ) );
+
+    note( "Matrix Multiplication" );
+    let translation = float4x4( float4( 1, 0, 0, 5 ), float4( 0, 1, 0, 6 ), float4( 0, 0, 1, 7 ), float4( 0, 0, 0, 1 ) );
+    let scale       = float4x4( float4( 2, 0, 0, 0 ), float4( 0, 2, 0, 0 ), float4( 0, 0, 2, 0 ), float4( 0, 0, 0, 1 ) );
+    assert_equal( ( translation * scale ) * float4( 1, 1, 1, 1 ), float4( 7, 8, 9, 1 ) );
+    assert_equal( ( scale * translation ) * float4( 1, 1, 1, 1 ), float4( 12, 14, 16, 1 ) );
+    assert_equal( ( float4x4() * translation ).rows[0], translation.rows[0] );
+    assert_equal( ( float4x4() * translation ).rows[2], translation.rows[2] );
 }
\ No newline at end of file
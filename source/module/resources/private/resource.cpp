@@ -127,7 +127,7 @@ namespace rnjin::core
 
         if ( reference_count == 0 )
         {
-            resource::events.resource_no_longer_referenced().send( *this );
+            resource::events.resource_no_longer_referenced().send( this );
         }
     }
 
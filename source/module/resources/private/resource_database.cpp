@@ -15,7 +15,7 @@ namespace rnjin::core
 
     resource_database::resource_database()
     {
-        handle_event( resource::events.resource_no_longer_referenced(), &resource_database::on_resource_no_longer_referenced );
+        handle_event( resource::events.resource_no_longer_referenced().dispatched(), &resource_database::on_resources_no_longer_referenced );
     }
     resource_database::~resource_database()
     {
@@ -31,15 +31,26 @@ namespace rnjin::core
         }
     }
 
-    void resource_database::on_resource_no_longer_referenced( const resource& old_resource )
+    void resource_database::on_resources_no_longer_referenced( const list<const resource*>& old_resources )
     {
-        let entry = entries.find( old_resource.get_path() );
-
-        if ( entry != entries.end() )
+        foreach ( resource_pointer : old_resources )
         {
-            // The resource is contained in this resource_database
-            let* resource_pointer = entry->second;
-            entries.erase( entry );
+            // Skip resources that aren't contained in this resource_database (or were already freed, if a resource
+            // lost its last reference more than once since the last dispatch)
+            let owned = owned_resources.find( resource_pointer );
+            if ( owned == owned_resources.end() )
+            {
+                continue;
+            }
+
+            // Resources can be referenced again before the queue is dispatched
+            if ( resource_pointer->has_references() )
+            {
+                continue;
+            }
+
+            owned_resources.erase( owned );
+            entries.erase( resource_pointer->get_path() );
 
             free_resource( resource_pointer );
         }
@@ -8,6 +8,7 @@
 #include <rnjin.hpp>
 
 #include "core/module.h"
+#include "core/public/queued_event.hpp"
 #include "file/module.h"
 
 namespace rnjin::core
@@ -63,7 +64,9 @@ namespace rnjin::core
             let_mutable& resource_no_longer_referenced get_mutable_value( resource_no_longer_referenced_event );
 
             private: // members
-            event<const resource&> resource_no_longer_referenced_event{ "last reference removed" };
+            // note: queued so resources aren't freed in the middle of whatever removed their last reference; the
+            //       frame loop calls resource_no_longer_referenced().dispatch() once per frame
+            queued_event<const resource*> resource_no_longer_referenced_event{ "last reference removed" };
         }
         events;
 
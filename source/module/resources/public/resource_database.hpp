@@ -39,6 +39,7 @@ namespace rnjin::core
                 new_resource->force_reload();
 
                 db.entries.emplace( file_path, new_resource );
+                db.owned_resources.insert( new_resource );
                 return resource::reference<T>( *new_resource );
             }
             else
@@ -49,9 +50,13 @@ namespace rnjin::core
         }
 
         private: // methods
-        void on_resource_no_longer_referenced( const resource& old_resource );
+        void on_resources_no_longer_referenced( const list<const resource*>& old_resources );
 
         private: // members
         dictionary<string, resource*> entries;
+
+        // Every resource in entries, so queued resources can be checked without reading them
+        // note: resources not loaded by this database may have been destroyed by the time they're dispatched
+        set<const resource*> owned_resources;
     };
 } // namespace rnjin::core
\ No newline at end of file
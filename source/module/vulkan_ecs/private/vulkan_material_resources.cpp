@@ -32,21 +32,35 @@ namespace rnjin::graphics::vulkan
     void material_collector::define() {}
     void material_collector::initialize()
     {
-        this->handle_event( ecs_material::events.added(), &material_collector::on_material_created );
+        this->handle_event( ecs_material::events.added_batch(), &material_collector::on_materials_created );
         this->handle_event( ecs_material::events.removed(), &material_collector::on_material_destroyed );
     }
 
     // Event Handlers
-    void material_collector::on_material_created( ecs_material& new_material, entity& owner )
+    // note: resources are added at the start of the next update, so resources for many new materials are added in one batch
+    // note: new materials arrive in batches, so space is reserved once per batch
+    void material_collector::on_materials_created( const ecs_material::added_span& new_materials )
     {
-        owner.add<material_resources>();
+        pending_changes.reserve_additions<material_resources>( new_materials.size() );
+        foreach ( entry : new_materials )
+        {
+            pending_changes.add<material_resources>( *entry.owner );
+        }
     }
     void material_collector::on_material_destroyed( const ecs_material& old_material, entity& owner )
     {
-        owner.remove<material_resources>();
+        // Resources that haven't been added yet only need to be forgotten
+        if ( not pending_changes.discard( owner ) )
+        {
+            owner.remove<material_resources>();
+        }
     }
 
     // System Methods
+    void material_collector::before_update()
+    {
+        pending_changes.apply();
+    }
     void material_collector::update( entity_components& components )
     {
         let& source              = components.readable<ecs_material>();
@@ -99,27 +113,43 @@ namespace rnjin::graphics::vulkan
     material_reference_collector::~material_reference_collector() {}
 
     // Initialization
-    void material_reference_collector::define() {}
+    void material_reference_collector::define()
+    {
+        // material_resources references need the material_resources they point to to have been added
+        depends_on<material_collector>();
+    }
     void material_reference_collector::initialize()
     {
-        this->handle_event( ecs_material::reference::events.added(), &material_reference_collector::on_material_reference_created );
+        this->handle_event( ecs_material::reference::events.added_batch(), &material_reference_collector::on_material_references_created );
         this->handle_event( ecs_material::reference::events.removed(), &material_reference_collector::on_material_reference_destroyed );
     }
 
     // Event Handlers
-    void material_reference_collector::on_material_reference_created( ecs_material::reference& new_material_reference, entity& owner )
+    void material_reference_collector::on_material_references_created( const ecs_material::reference::added_span& new_material_references )
     {
         // When a material reference component is created, also add a material_resources reference that points to
-        // the material_resources on the same owner (which is known to be added by on_material_created)
-        let* reference_owner_pointer = &new_material_reference.get_referenced_owner();
-        owner.add<material_resources::reference>( reference_owner_pointer );
+        // the material_resources on the same owner (which is known to be added by material_collector, which updates first)
+        pending_changes.reserve_additions<material_resources::reference>( new_material_references.size() );
+        foreach ( entry : new_material_references )
+        {
+            let* reference_owner_pointer = &entry.component->get_referenced_owner();
+            pending_changes.add<material_resources::reference>( *entry.owner, reference_owner_pointer );
+        }
     }
     void material_reference_collector::on_material_reference_destroyed( const ecs_material::reference& old_material_reference, entity& owner )
     {
-        owner.remove<material_resources::reference>();
+        // References that haven't been added yet only need to be forgotten
+        if ( not pending_changes.discard( owner ) )
+        {
+            owner.remove<material_resources::reference>();
+        }
     }
 
     // System Methods
+    void material_reference_collector::before_update()
+    {
+        pending_changes.apply();
+    }
     void material_reference_collector::update( entity_components& components )
     {
         let& source              = components.readable<ecs_material::reference>();
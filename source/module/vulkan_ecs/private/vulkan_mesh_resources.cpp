@@ -31,21 +31,35 @@ namespace rnjin::graphics::vulkan
     void mesh_collector::define() {}
     void mesh_collector::initialize()
     {
-        this->handle_event( ecs_mesh::events.added(), &mesh_collector::on_mesh_created );
+        this->handle_event( ecs_mesh::events.added_batch(), &mesh_collector::on_meshes_created );
         this->handle_event( ecs_mesh::events.removed(), &mesh_collector::on_mesh_destroyed );
     }
 
     // Event Handlers
-    void mesh_collector::on_mesh_created( ecs_mesh& new_mesh, entity& owner )
+    // note: resources are added at the start of the next update, so resources for many new meshes are added in one batch
+    // note: new meshes arrive in batches (ex. all meshes added by an entity_batch at once), so space is reserved once per batch
+    void mesh_collector::on_meshes_created( const ecs_mesh::added_span& new_meshes )
     {
-        owner.add<mesh_resources>();
+        pending_changes.reserve_additions<mesh_resources>( new_meshes.size() );
+        foreach ( entry : new_meshes )
+        {
+            pending_changes.add<mesh_resources>( *entry.owner );
+        }
     }
     void mesh_collector::on_mesh_destroyed( const ecs_mesh& old_mesh, entity& owner )
     {
-        owner.remove<mesh_resources>();
+        // Resources that haven't been added yet only need to be forgotten
+        if ( not pending_changes.discard( owner ) )
+        {
+            owner.remove<mesh_resources>();
+        }
     }
 
     // System Methods
+    void mesh_collector::before_update()
+    {
+        pending_changes.apply();
+    }
     void mesh_collector::update( entity_components& components )
     {
         let& source              = components.readable<ecs_mesh>();
@@ -84,43 +98,73 @@ namespace rnjin::graphics::vulkan
     /*                          Mesh Reference Collector                          */
     /* -------------------------------------------------------------------------- */
 
-    mesh_reference_collector::mesh_reference_collector() {}
+    mesh_reference_collector::mesh_reference_collector()
+    {
+        writes_to<mesh_resources::reference>();
+    }
     mesh_reference_collector::~mesh_reference_collector() {}
 
     // Initialization
-    void mesh_reference_collector::define() {}
+    void mesh_reference_collector::define()
+    {
+        // mesh_resources references need the mesh_resources they point to to have been added
+        depends_on<mesh_collector>();
+    }
     void mesh_reference_collector::initialize()
     {
-        this->handle_event( ecs_mesh::reference::events.added(), &mesh_reference_collector::on_mesh_reference_created );
+        this->handle_event( ecs_mesh::reference::events.added_batch(), &mesh_reference_collector::on_mesh_references_created );
         this->handle_event( ecs_mesh::reference::events.removed(), &mesh_reference_collector::on_mesh_reference_destroyed );
     }
 
     // Event Handlers
-    void mesh_reference_collector::on_mesh_reference_created( ecs_mesh::reference& new_mesh_reference, entity& owner )
+    void mesh_reference_collector::on_mesh_references_created( const ecs_mesh::reference::added_span& new_mesh_references )
     {
         // When a mesh reference component is created, also add a mesh_resources reference that points to
-        // the mesh_resources on the same owner (which is known to be added by on_mesh_created)
-        let* reference_owner_pointer = &new_mesh_reference.get_referenced_owner();
-        owner.add<mesh_resources::reference>( reference_owner_pointer );
+        // the mesh_resources on the same owner (which is known to be added by mesh_collector, which updates first)
+        pending_changes.reserve_additions<mesh_resources::reference>( new_mesh_references.size() );
+        foreach ( entry : new_mesh_references )
+        {
+            let* reference_owner_pointer = &entry.component->get_referenced_owner();
+            pending_changes.add<mesh_resources::reference>( *entry.owner, reference_owner_pointer );
+        }
     }
     void mesh_reference_collector::on_mesh_reference_destroyed( const ecs_mesh::reference& old_mesh_reference, entity& owner )
     {
-        owner.remove<mesh_resources::reference>();
+        // References that haven't been added yet only need to be forgotten
+        if ( not pending_changes.discard( owner ) )
+        {
+            owner.remove<mesh_resources::reference>();
+        }
     }
 
     // System Methods
-    void mesh_reference_collector::update( entity_components& components )
+    void mesh_reference_collector::before_update()
+    {
+        pending_changes.apply();
+    }
+    void mesh_reference_collector::update( observed_entity& affected )
     {
-        let& source              = components.readable<ecs_mesh::reference>();
-        let_mutable& destination = components.writable<mesh_resources::reference>();
+        let* owner = affected.get_entity();
+        if ( owner == nullptr )
+        {
+            return;
+        }
+
+        let* source              = owner->get<ecs_mesh::reference>();
+        let_mutable* destination = owner->get_mutable<mesh_resources::reference>();
+        if ( source == nullptr or destination == nullptr )
+        {
+            return;
+        }
 
-        let& source_owner      = source.get_referenced_owner();
-        let& destination_owner = destination.get_referenced_owner();
+        let& source_owner      = source->get_referenced_owner();
+        let& destination_owner = destination->get_referenced_owner();
 
         // Make sure the mesh_resources reference points to the mesh_resources owned by the same entity as the original ecs_mesh
         if ( source_owner.get_id() != destination_owner.get_id() )
         {
-            destination.set_target_from_owner( &source_owner );
+            destination->set_target_from_owner( &source_owner );
+            destination->mark_changed();
         }
     }
 } // namespace rnjin::graphics::vulkan
\ No newline at end of file
@@ -26,16 +26,29 @@ namespace rnjin::graphics::vulkan
     void model_collector::define() {}
     void model_collector::initialize()
     {
-        this->handle_event( ecs_model::events.added(), &model_collector::on_model_created );
+        this->handle_event( ecs_model::events.added_batch(), &model_collector::on_models_created );
         this->handle_event( ecs_model::events.removed(), &model_collector::on_model_destroyed );
     }
-    void model_collector::on_model_created( ecs_model& new_model, entity& owner )
+    void model_collector::on_models_created( const ecs_model::added_span& new_models )
     {
-        owner.add<model_resources>();
+        pending_changes.reserve_additions<model_resources>( new_models.size() );
+        foreach ( entry : new_models )
+        {
+            pending_changes.add<model_resources>( *entry.owner );
+        }
     }
     void model_collector::on_model_destroyed( const ecs_model& old_model, entity& owner )
     {
-        owner.remove<model_resources>();
+        // Resources that haven't been added yet only need to be forgotten
+        if ( not pending_changes.discard( owner ) )
+        {
+            owner.remove<model_resources>();
+        }
+    }
+
+    void model_collector::before_update()
+    {
+        pending_changes.apply();
     }
 
     void model_collector::update( entity_components& components )
@@ -44,9 +44,10 @@ namespace rnjin::graphics::vulkan
     /*                                   Systems                                  */
     /* -------------------------------------------------------------------------- */
 
-    class material_collector                                                       //
-      : public ecs::system<read_from<ecs_material>, write_to<material_resources>>, //
-        public event_receiver                                                      //
+    // note: only visits materials added or changed (with increment_version etc.) since the last update
+    class material_collector                                                     //
+      : public ecs::system<changed<ecs_material>, write_to<material_resources>>, //
+        public event_receiver                                                    //
     {
         public: // methods
         material_collector( resource_database& resources );
@@ -57,14 +58,18 @@ namespace rnjin::graphics::vulkan
         protected: // inherited
         void define() override;
         void update( entity_components& components ) override;
+        void before_update() override;
 
         private: // methods
-        void on_material_created( ecs_material& new_material, entity& owner );
+        void on_materials_created( const ecs_material::added_span& new_materials );
         void on_material_destroyed( const ecs_material& old_material, entity& owner );
 
         private: // members
         resource_database& resources;
 
+        // material_resources to add / remove at the start of the next update
+        ecs::command_buffer pending_changes;
+
         public: // TEMP
         vk::RenderPass temp_render_pass;
     };
@@ -82,10 +87,15 @@ namespace rnjin::graphics::vulkan
         protected: // inherited
         void define() override;
         void update( entity_components& components ) override;
+        void before_update() override;
 
         private: // methods
-        void on_material_reference_created( ecs_material::reference& new_material_reference, entity& owner );
+        void on_material_references_created( const ecs_material::reference::added_span& new_material_references );
         void on_material_reference_destroyed( const ecs_material::reference& old_material_reference, entity& owner );
+
+        private: // members
+        // material_resources references to add / remove at the start of the next update
+        ecs::command_buffer pending_changes;
     };
 }; // namespace rnjin::graphics::vulkan
 
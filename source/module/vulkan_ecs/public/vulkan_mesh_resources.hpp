@@ -46,9 +46,10 @@ namespace rnjin::graphics::vulkan
     /*                                   Systems                                  */
     /* -------------------------------------------------------------------------- */
 
-    class mesh_collector                                                   //
-      : public ecs::system<read_from<ecs_mesh>, write_to<mesh_resources>>, //
-        public event_receiver                                              //
+    // note: only visits meshes added since the last update, since mesh data can't change once it's added
+    class mesh_collector                                                 //
+      : public ecs::system<changed<ecs_mesh>, write_to<mesh_resources>>, //
+        public event_receiver                                            //
     {
         public: // methods
         mesh_collector( resource_database& resources );
@@ -59,18 +60,23 @@ namespace rnjin::graphics::vulkan
         protected: // inherited
         void define() override;
         void update( entity_components& components ) override;
+        void before_update() override;
 
         private: // methods
-        void on_mesh_created( ecs_mesh& new_mesh, entity& owner );
+        void on_meshes_created( const ecs_mesh::added_span& new_meshes );
         void on_mesh_destroyed( const ecs_mesh& old_mesh, entity& owner );
 
         private: // members
         resource_database& resources;
+
+        // mesh_resources to add / remove at the start of the next update
+        ecs::command_buffer pending_changes;
     };
-    
-    class mesh_reference_collector                                                               //
-      : public ecs::system<read_from<ecs_mesh::reference>, write_to<mesh_resources::reference>>, //
-        public event_receiver                                                                    //
+
+    // note: only visits entities whose mesh references were added or changed since the last update, rather than checking
+    //       every reference each frame, so retargeted references need to be marked as changed
+    class mesh_reference_collector //
+      : public ecs::observer<on_add<ecs_mesh::reference>, on_change<ecs_mesh::reference>>
     {
         public: // methods
         mesh_reference_collector();
@@ -80,11 +86,16 @@ namespace rnjin::graphics::vulkan
 
         protected: // inherited
         void define() override;
-        void update( entity_components& components ) override;
+        void update( observed_entity& affected ) override;
+        void before_update() override;
 
         private: // methods
-        void on_mesh_reference_created( ecs_mesh::reference& new_mesh_reference, entity& owner );
+        void on_mesh_references_created( const ecs_mesh::reference::added_span& new_mesh_references );
         void on_mesh_reference_destroyed( const ecs_mesh::reference& old_mesh_reference, entity& owner );
+
+        private: // members
+        // mesh_resources references to add / remove at the start of the next update
+        ecs::command_buffer pending_changes;
     };
 } // namespace rnjin::graphics::vulkan
 
@@ -48,10 +48,15 @@ namespace rnjin::graphics::vulkan
         protected: // inherited
         void define() override;
         void update( entity_components& components ) override;
+        void before_update() override;
 
         private: // methods
-        void on_model_created( ecs_model& new_model, entity& owner );
+        void on_models_created( const ecs_model::added_span& new_models );
         void on_model_destroyed( const ecs_model& old_model, entity& owner );
+
+        private: // members
+        // model_resources to add / remove at the start of the next update
+        ecs::command_buffer pending_changes;
     };
 }; // namespace rnjin::graphics::vulkan
 
@@ -0,0 +1,136 @@
+/* *** ** *** ** *** ** *** *
+ * Part of rnjin            *
+ * (c) Rajin Shankar, 2019  *
+ *        rajinshankar.com  *
+ * *** ** *** ** *** ** *** */
+
+#include "worker.hpp"
+
+namespace rnjin::worker
+{
+    // Whether the current thread is in the middle of a job
+    // note: used so nested run_all calls don't wait on jobs that can only be taken by the waiting thread
+    static thread_local bool running_job = false;
+
+    pool::pool( const usize worker_thread_count )
+      : current_job( nullptr ),   //
+        current_job_count( 0 ),   //
+        generation( 0 ),          //
+        active_worker_count( 0 ), //
+        stopping( false ),        //
+        next_index( 0 ),          //
+        finished_count( 0 )       //
+    {
+        workers.reserve( worker_thread_count );
+        for ( usize i = 0; i < worker_thread_count; i++ )
+        {
+            workers.emplace_back( &pool::work, this );
+        }
+    }
+    pool::~pool()
+    {
+        subregion
+        {
+            std::lock_guard<std::mutex> lock( state_lock );
+            stopping = true;
+        }
+        jobs_ready.notify_all();
+
+        for ( std::thread& worker_thread : workers )
+        {
+            worker_thread.join();
+        }
+    }
+
+    void pool::run_all( const usize job_count, const job& job_function )
+    {
+        // Run serially when there is nothing to split, nobody to split it with, or when called from inside a job
+        if ( job_count < 2 or workers.empty() or running_job )
+        {
+            for ( usize index = 0; index < job_count; index++ )
+            {
+                job_function( index );
+            }
+            return;
+        }
+
+        std::lock_guard<std::mutex> run_guard( run_lock );
+        subregion
+        {
+            std::lock_guard<std::mutex> lock( state_lock );
+            current_job       = &job_function;
+            current_job_count = job_count;
+            next_index        = 0;
+            finished_count    = 0;
+            generation += 1;
+        }
+        jobs_ready.notify_all();
+
+        // The calling thread takes jobs too, rather than sitting idle
+        take_jobs( job_function, job_count );
+
+        std::unique_lock<std::mutex> lock( state_lock );
+        jobs_finished.wait( lock, [this]() { return finished_count == current_job_count and active_worker_count == 0; } );
+        current_job       = nullptr;
+        current_job_count = 0;
+    }
+
+    // Worker thread loop, taking jobs each time a new set is started
+    void pool::work()
+    {
+        usize seen_generation = 0;
+
+        std::unique_lock<std::mutex> lock( state_lock );
+        while ( true )
+        {
+            jobs_ready.wait( lock, [&]() { return stopping or generation != seen_generation; } );
+            if ( stopping )
+            {
+                return;
+            }
+
+            // note: a set of jobs may have already finished by the time this worker wakes up
+            seen_generation = generation;
+            if ( current_job == nullptr )
+            {
+                continue;
+            }
+
+            const job* job_pointer = current_job;
+            let job_count          = current_job_count;
+            active_worker_count += 1;
+
+            lock.unlock();
+            take_jobs( *job_pointer, job_count );
+            lock.lock();
+
+            active_worker_count -= 1;
+            jobs_finished.notify_all();
+        }
+    }
+
+    // Take job indices until none are left
+    void pool::take_jobs( const job& job_function, const usize job_count )
+    {
+        running_job = true;
+        while ( true )
+        {
+            let index = next_index.fetch_add( 1 );
+            if ( index >= job_count )
+            {
+                break;
+            }
+
+            job_function( index );
+            finished_count.fetch_add( 1 );
+        }
+        running_job = false;
+    }
+
+    pool& pool::get_default()
+    {
+        static let hardware_thread_count = static_cast<usize>( std::thread::hardware_concurrency() );
+        static pool default_pool( hardware_thread_count > 1 ? hardware_thread_count - 1 : 0 );
+        return default_pool;
+    }
+} // namespace rnjin::worker
@@ -1,2 +1,68 @@
+/* *** ** *** ** *** ** *** *
+ * Part of rnjin            *
+ * (c) Rajin Shankar, 2019  *
+ *        rajinshankar.com  *
+ * *** ** *** ** *** ** *** */
+
 #pragma once
-#include <rnjin.hpp>
\ No newline at end of file
+#include <rnjin.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "core/module.h"
+
+namespace rnjin::worker
+{
+    // A fixed set of worker threads that run indexed jobs
+    // ex. `pool.run_all( 16, []( usize index ) { ... } );` calls the function with indices 0 through 15, spread over all threads
+    // note: the calling thread also takes jobs while it waits, so a pool with 0 worker threads runs everything serially
+    // note: only one set of jobs runs at a time; run_all calls from inside a job run serially on the calling thread
+    class pool
+    {
+        public: // types
+        using job = std::function<void( usize )>;
+
+        public: // methods
+        pool( const usize worker_thread_count );
+        ~pool();
+        no_copy( pool );
+
+        // Call `job` once for each index in [0, job_count), and return when all calls have finished
+        void run_all( const usize job_count, const job& job_function );
+
+        public: // accessors
+        let get_worker_thread_count get_value( workers.size() );
+
+        public: // static methods
+        // The pool shared by engine systems, with one worker thread per additional hardware thread
+        static pool& get_default();
+
+        private: // methods
+        void work();
+        void take_jobs( const job& job_function, const usize job_count );
+
+        private: // members
+        list<std::thread> workers;
+
+        std::mutex state_lock;
+        std::mutex run_lock;
+        std::condition_variable jobs_ready;
+        std::condition_variable jobs_finished;
+
+        // State of the current set of jobs
+        // note: `generation` changes with each run_all call so sleeping workers know new jobs are available
+        // note: run_all waits for all active workers to leave before returning, so none can see a stale job
+        const job* current_job;
+        usize current_job_count;
+        usize generation;
+        usize active_worker_count;
+        bool stopping;
+
+        std::atomic<usize> next_index;
+        std::atomic<usize> finished_count;
+    };
+} // namespace rnjin::worker
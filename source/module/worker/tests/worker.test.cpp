@@ -0,0 +1,59 @@
+/* *** ** *** ** *** ** *** *
+ * Part of rnjin            *
+ * (c) Rajin Shankar, 2019  *
+ *        rajinshankar.com  *
+ * *** ** *** ** *** ** *** */
+
+#include <rnjin.hpp>
+
+#include "test/module.h"
+#include "worker/module.h"
+
+using namespace rnjin;
+
+test( worker_pool_runs_each_job_once )
+{
+    worker::pool workers( 3 );
+    list<int> visits( 1000, 0 );
+
+    record( workers.run_all( visits.size(), [&]( const usize index ) { visits[index] += 1; } ) );
+
+    int total = 0;
+    foreach ( visit_count : visits )
+    {
+        total += visit_count;
+    }
+    assert_equal( total, 1000 );
+    assert_equal( visits[0], 1 );
+    assert_equal( visits[999], 1 );
+
+    // Pools can run any number of sets of jobs
+    record( workers.run_all( visits.size(), [&]( const usize index ) { visits[index] += 1; } ) );
+    assert_equal( visits[500], 2 );
+}
+
+test( worker_pool_nested_jobs )
+{
+    worker::pool workers( 2 );
+    list<int> visits( 16, 0 );
+
+    // Jobs started from inside a job run serially on that job's thread
+    record( workers.run_all( 4, [&]( const usize outer ) {
+        workers.run_all( 4, [&]( const usize inner ) { visits[outer * 4 + inner] += 1; } );
+    } ) );
+
+    assert_equal( visits[0], 1 );
+    assert_equal( visits[15], 1 );
+}
+
+test( worker_pool_without_threads )
+{
+    worker::pool workers( 0 );
+    list<usize> order;
+
+    // With no worker threads, jobs run in order on the calling thread
+    record( workers.run_all( 3, [&]( const usize index ) { order.push_back( index ); } ) );
+    assert_equal( order.size(), 3 );
+    assert_equal( order[0], 0 );
+    assert_equal( order[2], 2 );
+}